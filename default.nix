@@ -41,8 +41,9 @@ let
 
   build = bolos:
     let
-      app = bakingApp: pkgs.stdenv.mkDerivation {
-        name = "ledger-app-tezos-nano-${bolos.name}-${if bakingApp then "baking" else "wallet"}";
+      # kind: "wallet", "baking" or "combined"
+      app = kind: pkgs.stdenv.mkDerivation {
+        name = "ledger-app-tezos-nano-${bolos.name}-${kind}";
         inherit src;
         postConfigure = ''
           PATH="$BOLOS_ENV/clang-arm-fropi/bin:$PATH"
@@ -56,7 +57,7 @@ let
         BOLOS_SDK = bolos.sdk;
         BOLOS_ENV = bolos.env;
         makeFlags = [
-          "APP=${if bakingApp then "tezos_baking" else "tezos_wallet"}"
+          "APP=tezos_${kind}"
         ];
         installPhase = ''
           mkdir -p $out
@@ -88,20 +89,24 @@ let
         EOF
       '';
 
-      walletApp = app false;
-      bakingApp = app true;
+      walletApp = app "wallet";
+      bakingApp = app "baking";
+      combinedApp = app "combined";
     in {
       wallet = walletApp;
       baking = bakingApp;
+      combined = combinedApp;
 
       release = rec {
         wallet = mkRelease "wallet" "Tezos Wallet" walletApp;
         baking = mkRelease "baking" "Tezos Baking" bakingApp;
+        combined = mkRelease "combined" "Tezos Combined" combinedApp;
         all = pkgs.runCommand "ledger-app-tezos-${bolos.name}.tar.gz" {} ''
           mkdir ledger-app-tezos-${bolos.name}
 
           cp -r ${wallet} ledger-app-tezos-${bolos.name}/wallet
-          # No baking app for Nano X yet
+          # No baking app for Nano X yet. The combined app is built on its own until its RAM use on a
+          # real device is known.
           ${pkgs.lib.optionalString (bolos.name == "s") ''
             cp -r ${baking} ledger-app-tezos-${bolos.name}/baking
           ''}
@@ -159,7 +164,7 @@ let
              " "
              (x: "-analyzer-checker " + x)
              interestingExtrasAnalyzers;
-     in bakingApp: bolos: ((build bolos).${if bakingApp then "baking" else "wallet"}).overrideAttrs (old: {
+     in kind: bolos: ((build bolos).${kind}).overrideAttrs (old: {
        CCC_ANALYZER_HTML = "${placeholder "out"}";
        CCC_ANALYZER_OUTPUT_FORMAT = "html";
        CCC_ANALYZER_ANALYSIS = analysisOptions;
@@ -173,7 +178,7 @@ let
        installPhase = ''
         {
           echo "<html><title>Analyzer Report</title><body><h1>Clang Static Analyzer Results</h1>"
-          printf "<p>App: <code>${if bakingApp then "tezos_baking" else "tezos_wallet"}</code></p>"
+          printf "<p>App: <code>tezos_${kind}</code></p>"
           printf "<h2>File-results:</h2>"
           for html in "$out"/report*.html ; do
             echo "<p>"
@@ -207,10 +212,15 @@ in rec {
     s = nano.s.baking;
     x = nano.x.baking;
   };
+  combined = {
+    s = nano.s.combined;
+    x = nano.x.combined;
+  };
 
   clangAnalysis = mkTargets (bolos: {
-    baking = runClangStaticAnalyzer true bolos;
-    wallet = runClangStaticAnalyzer false bolos;
+    baking = runClangStaticAnalyzer "baking" bolos;
+    wallet = runClangStaticAnalyzer "wallet" bolos;
+    combined = runClangStaticAnalyzer "combined" bolos;
   });
 
   env = mkTargets (bolos: {
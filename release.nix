@@ -3,7 +3,9 @@ let
 in {
   analysis-nanos-wallet = ledger-app-tezos.clangAnalysis.s.wallet;
   analysis-nanos-baking = ledger-app-tezos.clangAnalysis.s.baking;
+  analysis-nanos-combined = ledger-app-tezos.clangAnalysis.s.combined;
   release-nanos-wallet = ledger-app-tezos.nano.s.release.wallet;
   release-nanos-baking = ledger-app-tezos.nano.s.release.baking;
+  release-nanos-combined = ledger-app-tezos.nano.s.release.combined;
   release-nanos-all = ledger-app-tezos.nano.s.release.all;
 }
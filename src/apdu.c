@@ -1,4 +1,5 @@
 #include "apdu.h"
+#include "apdu_sign.h"
 #include "globals.h"
 #include "to_string.h"
 #include "version.h"
@@ -34,6 +35,35 @@ size_t handle_apdu_git(uint8_t __attribute__((unused)) instruction) {
     return finalize_successful_send(tx);
 }
 
+static size_t run_continuation_step(void) {
+    bool done = false;
+    size_t tx = global.apdu.continuation.step(G_io_apdu_buffer, MAX_APDU_SIZE, &done);
+    if (done) {
+        memset(&global.apdu.continuation, 0, sizeof(global.apdu.continuation));
+        return finalize_successful_send(tx);
+    }
+    G_io_apdu_buffer[tx++] = SW_MORE >> 8;
+    G_io_apdu_buffer[tx++] = global.apdu.continuation.token;
+    return tx;
+}
+
+size_t start_continuation(continuation_step const step) {
+    check_null(step);
+    // Tokens keep counting across commands, so a stale INS_CONTINUE cannot resume a newer one.
+    if (++global.continuation_tokens == 0) global.continuation_tokens = 1;
+    global.apdu.continuation.step = step;
+    global.apdu.continuation.token = global.continuation_tokens;
+    return run_continuation_step();
+}
+
+size_t handle_apdu_continue(uint8_t __attribute__((unused)) instruction) {
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+    if (READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]) != 0) THROW(EXC_WRONG_LENGTH_FOR_INS);
+    if (global.apdu.continuation.step == NULL) THROW(EXC_REFERENCED_DATA_NOT_FOUND);
+    if (p1 != global.apdu.continuation.token) THROW(EXC_WRONG_VALUES);
+    return run_continuation_step();
+}
+
 #define CLA 0x80
 
 __attribute__((noreturn))
@@ -42,6 +72,12 @@ void main_loop(apdu_handler const *const handlers, size_t const handlers_size) {
     while (true) {
         BEGIN_TRY {
             TRY {
+                // The Nano S keeps its one sign session in `global.apdu.u`, which this APDU reuses or
+                // clears on error. An operation on screen is then gone, and its prompt can only reject.
+                if (SIGN_SESSION_COUNT == 1 && sign_prompt_pending()) {
+                    global.sign_sessions.prompted_overwritten = true;
+                }
+
                 // Process APDU of size rx
 
                 if (rx == 0) {
@@ -61,10 +97,22 @@ void main_loop(apdu_handler const *const handlers, size_t const handlers_size) {
                     THROW(EXC_WRONG_LENGTH);
                 }
 
+                // The handler table is static const data, so its entries need relocating.
                 uint8_t const instruction = G_io_apdu_buffer[OFFSET_INS];
-                apdu_handler const cb = instruction >= handlers_size
-                    ? handle_apdu_error
+
+                // Every other handler reuses `global.apdu.u`, which ends any long command in progress.
+                if (instruction != INS_CONTINUE) {
+                    memset(&global.apdu.continuation, 0, sizeof(global.apdu.continuation));
+                }
+                // Sign handlers select the session they work on; an error clears only that one.
+                global.sign_sessions.active = NULL;
+
+                apdu_handler const handler = instruction >= handlers_size
+                    ? NULL
                     : handlers[instruction];
+                apdu_handler const cb = handler == NULL
+                    ? handle_apdu_error
+                    : (apdu_handler)PIC(handler);
 
                 size_t const tx = cb(instruction);
                 rx = io_exchange(CHANNEL_APDU, tx);
@@ -38,6 +38,14 @@
 #define INS_QUERY_AUTH_KEY_WITH_CURVE 0x0D
 #define INS_HMAC 0x0E
 #define INS_SIGN_WITH_HASH 0x0F
+#define INS_HASH 0x10
+#define INS_CONTINUE 0x11
+#define INS_SCAN_PUBLIC_KEY_HASHES 0x12
+#define INS_SIGN_INTENT 0x13
+
+// Status word of a partial response: ISO 7816 "more data available", with the
+// continuation token in the low byte.
+#define SW_MORE 0x6100
 
 __attribute__((noreturn))
 void main_loop(apdu_handler const *const handlers, size_t const handlers_size);
@@ -67,8 +75,15 @@ static inline void require_hid(void) {
     }
 }
 
+// Long commands do a bounded amount of work per APDU so the host never hits its USB timeout.
+// A handler keeps its state in `global.apdu.u` and returns `start_continuation(step)`; while
+// `step` has work left, the response ends in SW_MORE and the host sends INS_CONTINUE with the
+// token as P1 to get the next chunk. Any other instruction abandons the command.
+size_t start_continuation(continuation_step const step);
+
 size_t provide_pubkey(uint8_t *const io_buffer, cx_ecfp_public_key_t const *const pubkey);
 
 size_t handle_apdu_error(uint8_t instruction);
 size_t handle_apdu_version(uint8_t instruction);
 size_t handle_apdu_git(uint8_t instruction);
+size_t handle_apdu_continue(uint8_t instruction);
@@ -0,0 +1,103 @@
+#include "apdu_hash.h"
+
+#include "apdu.h"
+#include "blake2b.h"
+#include "globals.h"
+#include "protocol.h"
+
+#include "cx.h"
+
+#include <string.h>
+
+#define G global.apdu.u.hash
+
+#define P1_FIRST 0x00
+#define P1_NEXT 0x01
+#define P1_BATCH 0x02 // Each message is prefixed with its 1-byte length
+#define P1_LAST_MARKER 0x80
+
+static inline void clear_data(void) {
+    memset(&G, 0, sizeof(G));
+}
+
+// P2 selects the digest size in bytes; 0 picks the size used for signing.
+static uint8_t parse_digest_size(uint8_t const p2) {
+    switch (p2) {
+        case 0: return SIGN_HASH_SIZE;
+        case HASH_SIZE: return HASH_SIZE;
+        case SIGN_HASH_SIZE: return SIGN_HASH_SIZE;
+        default: THROW(EXC_WRONG_PARAM);
+    }
+}
+
+static size_t hash_batch(uint8_t const *const in, size_t const in_size, uint8_t const digest_size) {
+    // Digests are written over the request, so hash from a copy of it.
+    clear_data();
+    memcpy(G.message_data, in, in_size);
+
+    size_t tx = 0;
+    size_t ix = 0;
+    while (ix < in_size) {
+        size_t const message_size = G.message_data[ix++];
+        if (message_size > in_size - ix) THROW(EXC_WRONG_LENGTH_FOR_INS);
+        if (tx + digest_size > MAX_APDU_SIZE) THROW(EXC_WRONG_LENGTH);
+
+        blake2b_hash_init(&G.hash_state, digest_size);
+        cx_hash((cx_hash_t *) &G.hash_state.state, CX_LAST,
+                &G.message_data[ix], message_size,
+                &G_io_apdu_buffer[tx], digest_size);
+
+        ix += message_size;
+        tx += digest_size;
+    }
+
+    clear_data();
+    return finalize_successful_send(tx);
+}
+
+size_t handle_apdu_hash(__attribute__((unused)) uint8_t instruction) {
+    uint8_t const *const buff = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+    uint8_t const p2 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_CURVE]);
+    uint8_t const buff_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (buff_size > MAX_APDU_SIZE) THROW(EXC_WRONG_LENGTH_FOR_INS);
+
+    bool const last = (p1 & P1_LAST_MARKER) != 0;
+    switch (p1 & ~P1_LAST_MARKER) {
+    case P1_FIRST:
+        clear_data();
+        G.digest_size = parse_digest_size(p2);
+        blake2b_hash_init(&G.hash_state, G.digest_size);
+        break;
+    case P1_NEXT:
+        if (G.digest_size == 0) THROW(EXC_WRONG_LENGTH_FOR_INS);
+        break;
+    case P1_BATCH:
+        // Self-contained: ends any stream in progress.
+        return hash_batch(buff, buff_size, parse_digest_size(p2));
+    default:
+        THROW(EXC_WRONG_PARAM);
+    }
+
+    // Hash contents of *previous* message (which may be empty).
+    blake2b_incremental_hash(
+        G.message_data, sizeof(G.message_data),
+        &G.message_data_length,
+        &G.hash_state);
+
+    if (G.message_data_length + buff_size > sizeof(G.message_data)) THROW(EXC_MEMORY_ERROR);
+
+    memmove(G.message_data + G.message_data_length, buff, buff_size);
+    G.message_data_length += buff_size;
+
+    if (!last) return finalize_successful_send(0);
+
+    size_t const tx = G.digest_size;
+    blake2b_finish_hash(
+        G_io_apdu_buffer, tx,
+        G.message_data, sizeof(G.message_data),
+        &G.message_data_length,
+        &G.hash_state);
+    clear_data();
+    return finalize_successful_send(tx);
+}
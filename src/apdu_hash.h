@@ -0,0 +1,5 @@
+#pragma once
+
+#include "apdu.h"
+
+size_t handle_apdu_hash(uint8_t instruction);
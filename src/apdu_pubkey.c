@@ -116,3 +116,44 @@ size_t handle_apdu_get_public_key(uint8_t instruction) {
         prompt_address(bake, cb, delay_reject);
     }
 }
+
+#define SCAN global.apdu.u.pkh_scan
+
+#define PKH_SCAN_BATCH 4 // Keys derived per APDU; each derivation takes tens of milliseconds
+
+static size_t scan_public_key_hashes_step(uint8_t *const out, size_t const out_size, bool *const done) {
+    size_t tx = 0;
+    for (size_t i = 0; i < PKH_SCAN_BATCH && SCAN.remaining > 0; i++) {
+        generate_compressed_public_key(&SCAN.public_key, SCAN.key.derivation_type, &SCAN.key.bip32_path);
+        compressed_public_key_hash(out + tx, out_size - tx, &SCAN.public_key);
+        tx += HASH_SIZE;
+
+        SCAN.key.bip32_path.components[SCAN.key.bip32_path.length - 1]++;
+        SCAN.remaining--;
+    }
+    *done = SCAN.remaining == 0;
+    return tx;
+}
+
+size_t handle_apdu_scan_public_key_hashes(__attribute__((unused)) uint8_t instruction) {
+    uint8_t const *const dataBuffer = G_io_apdu_buffer + OFFSET_CDATA;
+
+    if (READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]) != 0) THROW(EXC_WRONG_PARAM);
+
+    // Same rule as INS_GET_PUBLIC_KEY: no keys without a prompt over U2F
+    require_hid();
+
+    memset(&SCAN, 0, sizeof(SCAN));
+    SCAN.key.derivation_type = parse_derivation_type(READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_CURVE]));
+
+    size_t const cdata_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    size_t const path_size = read_bip32_path(&SCAN.key.bip32_path, dataBuffer, cdata_size);
+    if (cdata_size - path_size != sizeof(uint16_t)) THROW(EXC_WRONG_LENGTH_FOR_INS);
+    SCAN.remaining = READ_UNALIGNED_BIG_ENDIAN(uint16_t, dataBuffer + path_size);
+
+    // The last path component counts up; it may not wrap around into the other hardening range.
+    uint32_t const first = SCAN.key.bip32_path.components[SCAN.key.bip32_path.length - 1];
+    if (SCAN.remaining == 0 || ((first + SCAN.remaining - 1) ^ first) & 0x80000000) THROW(EXC_WRONG_VALUES);
+
+    return start_continuation(scan_public_key_hashes_step);
+}
@@ -3,3 +3,4 @@
 #include "apdu.h"
 
 size_t handle_apdu_get_public_key(uint8_t instruction);
+size_t handle_apdu_scan_public_key_hashes(uint8_t instruction);
@@ -3,6 +3,8 @@
 #include "apdu.h"
 #include "baking_auth.h"
 #include "base58.h"
+#include "blake2b.h"
+#include "forge.h"
 #include "globals.h"
 #include "key_macros.h"
 #include "keys.h"
@@ -15,86 +17,102 @@
 
 #include <string.h>
 
-#define G global.apdu.u.sign
+#define G SIGN_SESSION
+
+#define P1_SESSION_MASK 0x30 // Sign session the request belongs to
+#define P1_SESSION_SHIFT 4
 
 #define PARSE_ERROR() THROW(EXC_PARSE_ERROR)
 
-#define B2B_BLOCKBYTES 128
+static int perform_signature(bool const on_hash, bool const send_hash);
+#ifdef BAKING_APP
+static size_t refuse_baking_request(uint16_t const sw);
+#endif
 
-static inline void conditional_init_hash_state(blake2b_hash_state_t *const state) {
-    check_null(state);
-    if (!state->initialized) {
-        cx_blake2b_init(&state->state, SIGN_HASH_SIZE*8); // cx_blake2b_init takes size in bits.
-        state->initialized = true;
-    }
-}
+static bool sign_reject(void);
 
-static void blake2b_incremental_hash(
-    /*in/out*/ uint8_t *const out, size_t const out_size,
-    /*in/out*/ size_t *const out_length,
-    /*in/out*/ blake2b_hash_state_t *const state
-) {
-    check_null(out);
-    check_null(out_length);
-    check_null(state);
-
-    uint8_t *current = out;
-    while (*out_length > B2B_BLOCKBYTES) {
-        if (current - out > (int)out_size) THROW(EXC_MEMORY_ERROR);
-        conditional_init_hash_state(state);
-        cx_hash((cx_hash_t *) &state->state, 0, current, B2B_BLOCKBYTES, NULL, 0);
-        *out_length -= B2B_BLOCKBYTES;
-        current += B2B_BLOCKBYTES;
-    }
-    // TODO use circular buffer at some point
-    memmove(out, current, *out_length);
+bool sign_prompt_pending(void) {
+    // Every sign prompt rejects through `sign_reject`; any other prompt replaced it.
+    return global.sign_sessions.prompted != NULL && global.ui.cxl_callback == sign_reject;
 }
 
-static void blake2b_finish_hash(
-    /*out*/ uint8_t *const out, size_t const out_size,
-    /*in/out*/ uint8_t *const buff, size_t const buff_size,
-    /*in/out*/ size_t *const buff_length,
-    /*in/out*/ blake2b_hash_state_t *const state
-) {
-    check_null(out);
-    check_null(buff);
-    check_null(buff_length);
-    check_null(state);
-
-    conditional_init_hash_state(state);
-    blake2b_incremental_hash(buff, buff_size, buff_length, state);
-    cx_hash((cx_hash_t *) &state->state, CX_LAST, buff, *buff_length, out, out_size);
+// Makes the session named in P1 the one `G` refers to for the rest of the request.
+static void select_sign_session(uint8_t const p1) {
+    uint8_t const session = (p1 & P1_SESSION_MASK) >> P1_SESSION_SHIFT;
+    if (session >= SIGN_SESSION_COUNT) THROW(EXC_WRONG_PARAM);
+    apdu_sign_state_t *const selected = SIGN_SESSION_SLOT(session);
+    // The operation on screen must stay the one the user approves.
+    if (selected == global.sign_sessions.prompted && sign_prompt_pending()) THROW(EXC_SECURITY);
+    global.sign_sessions.active = selected;
 }
 
-static int perform_signature(bool const on_hash, bool const send_hash);
-
 static inline void clear_data(void) {
     memset(&G, 0, sizeof(G));
 }
 
+// The prompt callbacks run after later APDUs have pointed `G` at other sessions, so they go back to
+// the one captured here. A prompt already waiting keeps the screen, whichever session asks.
+static inline void start_prompt(void) {
+    if (sign_prompt_pending()) THROW(EXC_SECURITY);
+    global.sign_sessions.prompted = global.sign_sessions.active;
+    global.sign_sessions.prompted_overwritten = false;
+    G.timing.prompt_start_ticks = global.ticks;
+    G.timing.prompt_start_display_packets = global.display_packets;
+}
+
+// False when the session on screen no longer holds what was shown; the prompt then rejects.
+static bool resume_prompted_session(void) {
+    bool const intact = global.sign_sessions.prompted != NULL && !global.sign_sessions.prompted_overwritten;
+    global.sign_sessions.active = intact ? global.sign_sessions.prompted : NULL;
+    global.sign_sessions.prompted = NULL;
+    global.sign_sessions.prompted_overwritten = false;
+    return intact;
+}
+
+static inline void record_prompt(void) {
+    G.timing.prompt_ticks = global.ticks - G.timing.prompt_start_ticks;
+    G.timing.prompt_display_packets = global.display_packets - G.timing.prompt_start_display_packets;
+}
+
 static bool sign_without_hash_ok(void) {
+    if (!resume_prompted_session()) return sign_reject();
+    record_prompt();
     delayed_send(perform_signature(true, false));
     return true;
 }
 
 static bool sign_with_hash_ok(void) {
+    if (!resume_prompted_session()) return sign_reject();
+    record_prompt();
     delayed_send(perform_signature(true, true));
     return true;
 }
 
 static bool sign_reject(void) {
-    clear_data();
+    if (resume_prompted_session()) clear_data();
     delay_reject();
     return true; // Return to idle
 }
 
+// Whether the request is signed under the baking rules: no prompt, guarded by the high watermark.
+// In the combined app, only blocks and endorsements are; other operations go through the wallet.
+static inline bool is_baking_request(void) {
+#   if defined(BAKING_APP) && defined(WALLET_APP)
+        return G.magic_byte == MAGIC_BYTE_BLOCK || G.magic_byte == MAGIC_BYTE_BAKING_OP;
+#   elif defined(BAKING_APP)
+        return true;
+#   else
+        return false;
+#   endif
+}
+
 static bool is_operation_allowed(enum operation_tag tag) {
     switch (tag) {
         case OPERATION_TAG_ATHENS_DELEGATION: return true;
         case OPERATION_TAG_ATHENS_REVEAL: return true;
         case OPERATION_TAG_BABYLON_DELEGATION: return true;
         case OPERATION_TAG_BABYLON_REVEAL: return true;
-#       ifndef BAKING_APP
+#       ifdef WALLET_APP
             case OPERATION_TAG_PROPOSAL: return true;
             case OPERATION_TAG_BALLOT: return true;
             case OPERATION_TAG_ATHENS_ORIGINATION: return true;
@@ -115,9 +133,9 @@ static bool parse_allowed_operations(
 ) {
     return parse_operations(out, in, in_size, key->derivation_type, &key->bip32_path, &is_operation_allowed);
 }
+#endif
 
-#else
-
+#ifdef WALLET_APP
 static bool parse_allowed_operation_packet(
     struct parsed_operation_group *const out,
     uint8_t const *const in,
@@ -158,9 +176,9 @@ size_t baking_sign_complete(bool const send_hash) {
     switch (G.magic_byte) {
         case MAGIC_BYTE_BLOCK:
         case MAGIC_BYTE_BAKING_OP:
+            // Already checked when the packet was parsed; checked again right before signing.
             guard_baking_authorized(&G.parsed_baking_data, &G.key);
             return perform_signature(true, send_hash);
-            break;
 
         case MAGIC_BYTE_UNSAFE_OP:
             {
@@ -174,6 +192,7 @@ size_t baking_sign_complete(bool const send_hash) {
                     COMPARE(&G.maybe_ops.v.operation.destination, &G.maybe_ops.v.signing) == 0
                 ) {
                     ui_callback_t const ok_c = send_hash ? sign_with_hash_ok : sign_without_hash_ok;
+                    start_prompt();
                     prompt_register_delegate(ok_c, sign_reject);
                 }
                 THROW(EXC_SECURITY);
@@ -186,9 +205,13 @@ size_t baking_sign_complete(bool const send_hash) {
     }
 }
 
-#else // ifdef BAKING_APP -----------------------------------------------------
+#endif // ifdef BAKING_APP ----------------------------------------------------
+
+#ifdef WALLET_APP // ----------------------------------------------------------
 
 static bool sign_unsafe_ok(void) {
+    if (!resume_prompted_session()) return sign_reject();
+    record_prompt();
     delayed_send(perform_signature(false, false));
     return true;
 }
@@ -459,6 +482,7 @@ static size_t wallet_sign_complete(uint8_t instruction) {
     };
 
     REGISTER_STATIC_UI_VALUE(TYPE_INDEX, "Operation");
+    start_prompt();
 
     if (instruction == INS_SIGN_UNSAFE) {
         static const char *const prehashed_prompts[] = {
@@ -500,11 +524,60 @@ unsafe:
     }
 }
 
-#endif // ifdef BAKING_APP ----------------------------------------------------
+#define P1_INTENT_SEND_HASH 0x01 // Answer with the hash of the forged operation instead of its bytes
+
+// Signs a transaction or delegation forged here from its fields, so nothing needs parsing.
+size_t handle_apdu_sign_intent(__attribute__((unused)) uint8_t instruction) {
+    uint8_t const *const buff = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+    uint8_t const buff_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (buff_size > MAX_APDU_SIZE) THROW(EXC_WRONG_LENGTH_FOR_INS);
+    if ((p1 & ~(P1_INTENT_SEND_HASH | P1_SESSION_MASK)) != 0) THROW(EXC_WRONG_PARAM);
+    bool const send_hash = (p1 & P1_INTENT_SEND_HASH) != 0;
+
+    select_sign_session(p1);
+    clear_data();
+    size_t const path_size = read_bip32_path(&G.key.bip32_path, buff, buff_size);
+    G.key.derivation_type = parse_derivation_type(READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_CURVE]));
+
+    transfer_intent_t intent;
+    parse_transfer_intent(&intent, buff + path_size, buff_size - path_size);
+
+    // Fill in what the parser would have found in the forged operation. The source is the signing key.
+    struct parsed_operation_group *const ops = &G.maybe_ops.v;
+    parse_operations_init(ops, G.key.derivation_type, &G.key.bip32_path, &G.parse_state);
+    memcpy(&intent.source, &ops->signing, sizeof(intent.source));
+    ops->operation.tag = intent.tag;
+    memcpy(&ops->operation.destination, &intent.destination, sizeof(ops->operation.destination));
+    ops->operation.amount = intent.amount;
+    ops->total_fee = intent.fee;
+    ops->total_storage_limit = intent.storage_limit;
+    G.maybe_ops.is_valid = true;
+    G.magic_byte = MAGIC_BYTE_UNSAFE_OP;
+
+    size_t const forged_size = forge_transfer_intent(G.forged_intent.bytes, sizeof(G.forged_intent.bytes), &intent);
+    G.forged_intent.length = send_hash ? 0 : forged_size;
+
+    memcpy(G.message_data, G.forged_intent.bytes, forged_size);
+    G.message_data_length = forged_size;
+    blake2b_finish_hash(
+        G.final_hash, sizeof(G.final_hash),
+        G.message_data, sizeof(G.message_data),
+        &G.message_data_length,
+        &G.hash_state);
+
+    start_prompt();
+    prompt_transaction(ops, &G.key, send_hash ? sign_with_hash_ok : sign_without_hash_ok, sign_reject);
+    THROW(EXC_MEMORY_ERROR); // Transactions and delegations always prompt
+}
+
+#endif // ifdef WALLET_APP ----------------------------------------------------
 
 #define P1_FIRST 0x00
 #define P1_NEXT 0x01
 #define P1_HASH_ONLY_NEXT 0x03 // You only need it once
+#define P1_RESEND 0x04
+#define P1_TIMING_TRAILER 0x40 // Append how long the prompt was up to the response
 #define P1_LAST_MARKER 0x80
 
 static uint8_t get_magic_byte_or_throw(uint8_t const *const buff, size_t const buff_size) {
@@ -525,20 +598,87 @@ static uint8_t get_magic_byte_or_throw(uint8_t const *const buff, size_t const b
     }
 }
 
+#ifdef WALLET_APP
+// Sends the last approved signature again if the request names the same key and hash.
+static size_t resend_last_signature(uint8_t const *const buff, size_t const buff_size, bool const send_hash) {
+    bip32_path_with_curve_t key;
+    size_t const path_size = read_bip32_path(&key.bip32_path, buff, buff_size);
+    key.derivation_type = parse_derivation_type(READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_CURVE]));
+    if (buff_size - path_size != sizeof(global.last_signature.final_hash)) THROW(EXC_WRONG_LENGTH_FOR_INS);
+
+    if (global.last_signature.ticks_left == 0 ||
+        !bip32_path_with_curve_eq(&key, &global.last_signature.key) ||
+        memcmp(buff + path_size, global.last_signature.final_hash, sizeof(global.last_signature.final_hash)) != 0
+    ) THROW(EXC_WRONG_VALUES);
+
+    size_t tx = 0;
+    if (send_hash) {
+        memcpy(&G_io_apdu_buffer[tx], global.last_signature.final_hash, sizeof(global.last_signature.final_hash));
+        tx += sizeof(global.last_signature.final_hash);
+    }
+    memcpy(&G_io_apdu_buffer[tx], global.last_signature.signature, global.last_signature.signature_length);
+    tx += global.last_signature.signature_length;
+    return finalize_successful_send(tx);
+}
+#endif
+
+#ifdef BAKING_APP
+static void parse_baking_packet(uint8_t const *const buff, size_t const buff_size) {
+    if (G.packet_index != 1) PARSE_ERROR(); // Only parse a single packet when baking
+
+    if (G.magic_byte == MAGIC_BYTE_UNSAFE_OP) {
+        // Parse the operation. It will be verified in `baking_sign_complete`.
+        G.maybe_ops.is_valid = parse_allowed_operations(&G.maybe_ops.v, buff, buff_size, &G.key);
+    } else {
+        // This should be a baking operation so parse it.
+        if (!parse_baking_data(&G.parsed_baking_data, buff, buff_size)) PARSE_ERROR();
+    }
+}
+#endif
+
+#ifdef WALLET_APP
+static void parse_wallet_packet(uint8_t const *const buff, size_t const buff_size) {
+    if (G.packet_index == 1) {
+        G.maybe_ops.is_valid = false;
+        parse_operations_init(&G.maybe_ops.v, G.key.derivation_type, &G.key.bip32_path, &G.parse_state);
+    }
+
+    parse_allowed_operation_packet(&G.maybe_ops.v, buff, buff_size);
+}
+#endif
+
+static size_t sign_complete(uint8_t const instruction) {
+#   if defined(BAKING_APP) && defined(WALLET_APP)
+        if (is_baking_request()) return baking_sign_complete(instruction == INS_SIGN_WITH_HASH);
+#   endif
+#   ifdef WALLET_APP
+        return wallet_sign_complete(instruction);
+#   else
+        return baking_sign_complete(instruction == INS_SIGN_WITH_HASH);
+#   endif
+}
+
 static size_t handle_apdu(bool const enable_hashing, bool const enable_parsing, uint8_t const instruction) {
     uint8_t *const buff = &G_io_apdu_buffer[OFFSET_CDATA];
     uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
     uint8_t const buff_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
     if (buff_size > MAX_APDU_SIZE) THROW(EXC_WRONG_LENGTH_FOR_INS);
 
+    select_sign_session(p1);
+
     bool last = (p1 & P1_LAST_MARKER) != 0;
-    switch (p1 & ~P1_LAST_MARKER) {
+    bool const timing = (p1 & P1_TIMING_TRAILER) != 0;
+    switch (p1 & ~(P1_LAST_MARKER | P1_TIMING_TRAILER | P1_SESSION_MASK)) {
     case P1_FIRST:
         clear_data();
+        G.timing.requested = timing;
         read_bip32_path(&G.key.bip32_path, buff, buff_size);
         G.key.derivation_type = parse_derivation_type(READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_CURVE]));
         return finalize_successful_send(0);
-#ifndef BAKING_APP
+#ifdef WALLET_APP
+    case P1_RESEND:
+        if (!enable_hashing || last) THROW(EXC_WRONG_PARAM);
+        return resend_last_signature(buff, buff_size, instruction == INS_SIGN_WITH_HASH);
     case P1_HASH_ONLY_NEXT:
         // This is a debugging Easter egg
         G.hash_only = true;
@@ -550,6 +690,7 @@ static size_t handle_apdu(bool const enable_hashing, bool const enable_parsing,
         // Guard against overflow
         if (G.packet_index >= 0xFF) PARSE_ERROR();
         G.packet_index++;
+        G.timing.requested |= timing;
 
         break;
     default:
@@ -557,26 +698,27 @@ static size_t handle_apdu(bool const enable_hashing, bool const enable_parsing,
     }
 
     if (enable_parsing) {
-#       ifdef BAKING_APP
-            if (G.packet_index != 1) PARSE_ERROR(); // Only parse a single packet when baking
-
+        if (G.packet_index == 1) {
             G.magic_byte = get_magic_byte_or_throw(buff, buff_size);
-            if (G.magic_byte == MAGIC_BYTE_UNSAFE_OP) {
-                // Parse the operation. It will be verified in `baking_sign_complete`.
-                G.maybe_ops.is_valid = parse_allowed_operations(&G.maybe_ops.v, buff, buff_size, &G.key);
+        }
+#       if defined(BAKING_APP) && defined(WALLET_APP)
+            if (is_baking_request()) {
+                parse_baking_packet(buff, buff_size);
             } else {
-                // This should be a baking operation so parse it.
-                if (!parse_baking_data(&G.parsed_baking_data, buff, buff_size)) PARSE_ERROR();
+                parse_wallet_packet(buff, buff_size);
             }
+#       elif defined(BAKING_APP)
+            parse_baking_packet(buff, buff_size);
 #       else
-	    if (G.packet_index == 1) {
-	        G.maybe_ops.is_valid = false;
-                G.magic_byte = get_magic_byte_or_throw(buff, buff_size);
-		parse_operations_init(&G.maybe_ops.v, G.key.derivation_type, &G.key.bip32_path, &G.parse_state);
-	    }
-
-	    parse_allowed_operation_packet(&G.maybe_ops.v, buff, buff_size);
+            parse_wallet_packet(buff, buff_size);
+#       endif
 
+#       ifdef BAKING_APP
+            // Refuse stale levels and unauthorized keys before spending any time on hashing.
+            if (G.magic_byte == MAGIC_BYTE_BLOCK || G.magic_byte == MAGIC_BYTE_BAKING_OP) {
+                uint16_t const refusal = baking_refusal(&G.parsed_baking_data, &G.key);
+                if (refusal != 0) return refuse_baking_request(refusal);
+            }
 #       endif
     }
 
@@ -609,12 +751,7 @@ static size_t handle_apdu(bool const enable_hashing, bool const enable_parsing,
 
 	G.maybe_ops.is_valid = parse_operations_final(&G.parse_state, &G.maybe_ops.v);
 
-        return
-#           ifdef BAKING_APP
-                baking_sign_complete(instruction == INS_SIGN_WITH_HASH);
-#           else
-                wallet_sign_complete(instruction);
-#           endif
+        return sign_complete(instruction);
     } else {
         return finalize_successful_send(0);
     }
@@ -632,14 +769,56 @@ size_t handle_apdu_sign_with_hash(uint8_t instruction) {
     return handle_apdu(enable_hashing, enable_parsing, instruction);
 }
 
+static size_t write_u32_big_endian(size_t tx, uint32_t const word) {
+    G_io_apdu_buffer[tx++] = word >> 24;
+    G_io_apdu_buffer[tx++] = word >> 16;
+    G_io_apdu_buffer[tx++] = word >> 8;
+    G_io_apdu_buffer[tx++] = word;
+    return tx;
+}
+
+// Trailer: ticker period in milliseconds, then the ticks the prompt was up and the display packets
+// sent meanwhile, as big-endian 32-bit words. Both are 0 when the request did not prompt.
+static size_t append_timing_trailer(size_t tx) {
+    if (!G.timing.requested) return tx;
+    G_io_apdu_buffer[tx++] = TICKER_PERIOD_MS;
+    tx = write_u32_big_endian(tx, G.timing.prompt_ticks);
+    tx = write_u32_big_endian(tx, G.timing.prompt_display_packets);
+    return tx;
+}
+
+#ifdef BAKING_APP
+// Refusal: the high watermark the request was checked against (level as a big-endian 32-bit word,
+// then whether it had an endorsement), which watermark that is (0 main, 1 test), and the main
+// chain id, followed by `sw`.
+static size_t refuse_baking_request(uint16_t const sw) {
+    high_watermark_t volatile const *const hwm = select_hwm_by_chain(G.parsed_baking_data.chain_id, &N_data);
+
+    size_t tx = 0;
+    tx = write_u32_big_endian(tx, hwm->highest_level);
+    G_io_apdu_buffer[tx++] = hwm->had_endorsement;
+    G_io_apdu_buffer[tx++] = hwm == &N_data.hwm.main ? 0 : 1;
+    tx = write_u32_big_endian(tx, N_data.main_chain_id.v);
+    G_io_apdu_buffer[tx++] = sw >> 8;
+    G_io_apdu_buffer[tx++] = sw;
+
+    clear_data(); // As if `sw` had been thrown
+    return tx;
+}
+#endif
+
 static int perform_signature(bool const on_hash, bool const send_hash) {
-#   ifdef BAKING_APP
-        write_high_water_mark(&G.parsed_baking_data);
-#   else
+#   ifdef WALLET_APP
         if (on_hash && G.hash_only) {
             memcpy(G_io_apdu_buffer, G.final_hash, sizeof(G.final_hash));
+            size_t const tx = append_timing_trailer(sizeof(G.final_hash));
             clear_data();
-            return finalize_successful_send(sizeof(G.final_hash));
+            return finalize_successful_send(tx);
+        }
+#   endif
+#   ifdef BAKING_APP
+        if (is_baking_request()) {
+            write_high_water_mark(&G.parsed_baking_data);
         }
 #   endif
 
@@ -648,13 +827,33 @@ static int perform_signature(bool const on_hash, bool const send_hash) {
         memcpy(&G_io_apdu_buffer[tx], G.final_hash, sizeof(G.final_hash));
         tx += sizeof(G.final_hash);
     }
+#   ifdef WALLET_APP
+        if (G.forged_intent.length != 0) {
+            G_io_apdu_buffer[tx++] = G.forged_intent.length;
+            memcpy(&G_io_apdu_buffer[tx], G.forged_intent.bytes, G.forged_intent.length);
+            tx += G.forged_intent.length;
+        }
+#   endif
 
     uint8_t const *const data = on_hash ? G.final_hash : G.message_data;
     size_t const data_length = on_hash ? sizeof(G.final_hash) : G.message_data_length;
-    tx += WITH_KEY_PAIR(G.key, key_pair, size_t, ({
+    size_t const signature_length = WITH_KEY_PAIR(G.key, key_pair, size_t, ({
         sign(&G_io_apdu_buffer[tx], MAX_SIGNATURE_SIZE, G.key.derivation_type, key_pair, data, data_length);
     }));
 
+#   ifdef WALLET_APP
+        if (on_hash && !is_baking_request()) {
+            memcpy(&global.last_signature.key, &G.key, sizeof(global.last_signature.key));
+            memcpy(global.last_signature.final_hash, G.final_hash, sizeof(global.last_signature.final_hash));
+            memcpy(global.last_signature.signature, &G_io_apdu_buffer[tx], signature_length);
+            global.last_signature.signature_length = signature_length;
+            global.last_signature.ticks_left = LAST_SIGNATURE_TICKS;
+        }
+#   endif
+    tx += signature_length;
+
+    tx = append_timing_trailer(tx);
+
     clear_data();
     return finalize_successful_send(tx);
 }
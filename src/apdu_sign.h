@@ -4,3 +4,9 @@
 
 size_t handle_apdu_sign(uint8_t instruction);
 size_t handle_apdu_sign_with_hash(uint8_t instruction);
+
+// Whether a sign prompt is waiting for the user.
+bool sign_prompt_pending(void);
+#ifdef WALLET_APP
+size_t handle_apdu_sign_intent(uint8_t instruction);
+#endif
@@ -60,11 +60,17 @@ bool is_path_authorized(derivation_type_t const derivation_type, bip32_path_t co
         bip32_paths_eq(bip32_path, (const bip32_path_t *)&N_data.baking_key.bip32_path);
 }
 
-void guard_baking_authorized(parsed_baking_data_t const *const baking_info, bip32_path_with_curve_t const *const key) {
+uint16_t baking_refusal(parsed_baking_data_t const *const baking_info, bip32_path_with_curve_t const *const key) {
     check_null(baking_info);
     check_null(key);
-    if (!is_path_authorized(key->derivation_type, &key->bip32_path)) THROW(EXC_SECURITY);
-    if (!is_level_authorized(baking_info)) THROW(EXC_WRONG_VALUES);
+    if (!is_path_authorized(key->derivation_type, &key->bip32_path)) return EXC_SECURITY;
+    if (!is_level_authorized(baking_info)) return EXC_WRONG_VALUES;
+    return 0;
+}
+
+void guard_baking_authorized(parsed_baking_data_t const *const baking_info, bip32_path_with_curve_t const *const key) {
+    uint16_t const refusal = baking_refusal(baking_info, key);
+    if (refusal != 0) THROW(refusal);
 }
 
 struct block_wire {
@@ -11,6 +11,8 @@
 #include <stdint.h>
 
 void authorize_baking(derivation_type_t const derivation_type, bip32_path_t const *const bip32_path);
+// Returns 0 if `key` may sign `baking_data`, or else the status word refusing it.
+uint16_t baking_refusal(parsed_baking_data_t const *const baking_data, bip32_path_with_curve_t const *const key);
 void guard_baking_authorized(parsed_baking_data_t const *const baking_data, bip32_path_with_curve_t const *const key);
 bool is_path_authorized(derivation_type_t const derivation_type, bip32_path_t const *const bip32_path);
 bool is_valid_level(level_t level);
@@ -12,6 +12,7 @@
 #include <sys/types.h>
 
 #include "base58.h"
+#include "scratch.h"
 
 static const char b58digits_ordered[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
@@ -26,7 +27,7 @@ bool b58enc(/* out */ char *b58, /* in/out */ size_t *b58sz, const void *data, s
         ++zcount;
 
     size = (binsz - zcount) * 138 / 100 + 1;
-    uint8_t buf[size];
+    uint8_t *const buf = scratch_acquire(size);
     memset(buf, 0, size);
 
     for (i = zcount, high = size - 1; i < binsz; ++i, high = j)
@@ -44,6 +45,7 @@ bool b58enc(/* out */ char *b58, /* in/out */ size_t *b58sz, const void *data, s
     if (*b58sz <= zcount + size - j)
     {
         *b58sz = zcount + size - j + 1;
+        scratch_release(buf);
         return false;
     }
 
@@ -54,5 +56,6 @@ bool b58enc(/* out */ char *b58, /* in/out */ size_t *b58sz, const void *data, s
     b58[i] = '\0';
     *b58sz = i + 1;
 
+    scratch_release(buf);
     return true;
 }
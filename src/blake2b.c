@@ -0,0 +1,58 @@
+#include "blake2b.h"
+
+#include "exception.h"
+#include "types.h"
+
+#include <string.h>
+
+#define B2B_BLOCKBYTES 128
+
+void blake2b_hash_init(blake2b_hash_state_t *const state, size_t const digest_size) {
+    check_null(state);
+    cx_blake2b_init(&state->state, digest_size*8); // cx_blake2b_init takes size in bits.
+    state->initialized = true;
+}
+
+static inline void conditional_init_hash_state(blake2b_hash_state_t *const state) {
+    check_null(state);
+    if (!state->initialized) {
+        blake2b_hash_init(state, SIGN_HASH_SIZE);
+    }
+}
+
+void blake2b_incremental_hash(
+    /*in/out*/ uint8_t *const out, size_t const out_size,
+    /*in/out*/ size_t *const out_length,
+    /*in/out*/ blake2b_hash_state_t *const state
+) {
+    check_null(out);
+    check_null(out_length);
+    check_null(state);
+
+    uint8_t *current = out;
+    while (*out_length > B2B_BLOCKBYTES) {
+        if (current - out > (int)out_size) THROW(EXC_MEMORY_ERROR);
+        conditional_init_hash_state(state);
+        cx_hash((cx_hash_t *) &state->state, 0, current, B2B_BLOCKBYTES, NULL, 0);
+        *out_length -= B2B_BLOCKBYTES;
+        current += B2B_BLOCKBYTES;
+    }
+    // TODO use circular buffer at some point
+    memmove(out, current, *out_length);
+}
+
+void blake2b_finish_hash(
+    /*out*/ uint8_t *const out, size_t const out_size,
+    /*in/out*/ uint8_t *const buff, size_t const buff_size,
+    /*in/out*/ size_t *const buff_length,
+    /*in/out*/ blake2b_hash_state_t *const state
+) {
+    check_null(out);
+    check_null(buff);
+    check_null(buff_length);
+    check_null(state);
+
+    conditional_init_hash_state(state);
+    blake2b_incremental_hash(buff, buff_size, buff_length, state);
+    cx_hash((cx_hash_t *) &state->state, CX_LAST, buff, *buff_length, out, out_size);
+}
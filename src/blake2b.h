@@ -0,0 +1,30 @@
+#pragma once
+
+#include "os_cx.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    cx_blake2b_t state;
+    bool initialized;
+} blake2b_hash_state_t;
+
+// Initializes `state` for a digest of `digest_size` bytes.
+// States that are never initialized explicitly produce a SIGN_HASH_SIZE digest.
+void blake2b_hash_init(blake2b_hash_state_t *const state, size_t const digest_size);
+
+// Hashes every full block of `buff` except the last one and moves the remainder
+// to the front of `buff`, updating `buff_length` accordingly.
+void blake2b_incremental_hash(
+    /*in/out*/ uint8_t *const buff, size_t const buff_size,
+    /*in/out*/ size_t *const buff_length,
+    /*in/out*/ blake2b_hash_state_t *const state);
+
+// Hashes whatever remains in `buff` and writes the final digest to `out`.
+void blake2b_finish_hash(
+    /*out*/ uint8_t *const out, size_t const out_size,
+    /*in/out*/ uint8_t *const buff, size_t const buff_size,
+    /*in/out*/ size_t *const buff_length,
+    /*in/out*/ blake2b_hash_state_t *const state);
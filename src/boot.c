@@ -41,7 +41,7 @@ __attribute__((section(".boot"))) int main(void) {
                 BLE_power(1, "Nano X");
 #endif // HAVE_BLE
 
-                ui_initial_screen();
+                ui_defer_initial_screen();
 
                 app_main();
             }
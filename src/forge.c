@@ -0,0 +1,159 @@
+#ifdef WALLET_APP
+
+#include "forge.h"
+
+#include "exception.h"
+#include "operations.h"
+#include "protocol.h"
+
+#include <string.h>
+
+struct transfer_intent_wire {
+    uint8_t branch[OPERATION_BRANCH_SIZE];
+    uint8_t tag;
+    uint64_t fee;
+    uint64_t counter;
+    uint64_t gas_limit;
+    uint64_t storage_limit;
+} __attribute__((packed));
+
+struct transaction_intent_wire {
+    uint64_t amount;
+    struct contract destination;
+} __attribute__((packed));
+
+static signature_type_t parse_signature_type(raw_tezos_header_signature_type_t const *const raw) {
+    switch (READ_UNALIGNED_BIG_ENDIAN(uint8_t, &raw->v)) {
+        case 0: return SIGNATURE_TYPE_ED25519;
+        case 1: return SIGNATURE_TYPE_SECP256K1;
+        case 2: return SIGNATURE_TYPE_SECP256R1;
+        default: THROW(EXC_WRONG_VALUES);
+    }
+}
+
+static uint8_t unparse_signature_type(signature_type_t const signature_type) {
+    switch (signature_type) {
+        case SIGNATURE_TYPE_ED25519: return 0;
+        case SIGNATURE_TYPE_SECP256K1: return 1;
+        case SIGNATURE_TYPE_SECP256R1: return 2;
+        default: THROW(EXC_WRONG_VALUES);
+    }
+}
+
+static void parse_implicit_contract(parsed_contract_t *const out, struct implicit_contract const *const in) {
+    out->originated = 0;
+    out->signature_type = parse_signature_type(&in->signature_type);
+    memcpy(out->hash, in->pkh, sizeof(out->hash));
+}
+
+void parse_transfer_intent(transfer_intent_t *const out, uint8_t const *const in, size_t const in_size) {
+    check_null(out);
+    check_null(in);
+    memset(out, 0, sizeof(*out));
+
+    if (in_size < sizeof(struct transfer_intent_wire)) THROW(EXC_WRONG_LENGTH_FOR_INS);
+    struct transfer_intent_wire const *const wire = (struct transfer_intent_wire const *)in;
+    size_t const rest_size = in_size - sizeof(*wire);
+    uint8_t const *const rest = in + sizeof(*wire);
+
+    memcpy(out->branch, wire->branch, sizeof(out->branch));
+    out->fee = READ_UNALIGNED_BIG_ENDIAN(uint64_t, &wire->fee);
+    out->counter = READ_UNALIGNED_BIG_ENDIAN(uint64_t, &wire->counter);
+    out->gas_limit = READ_UNALIGNED_BIG_ENDIAN(uint64_t, &wire->gas_limit);
+    out->storage_limit = READ_UNALIGNED_BIG_ENDIAN(uint64_t, &wire->storage_limit);
+
+    switch (READ_UNALIGNED_BIG_ENDIAN(uint8_t, &wire->tag)) {
+        case OPERATION_TAG_BABYLON_TRANSACTION: {
+            if (rest_size != sizeof(struct transaction_intent_wire)) THROW(EXC_WRONG_LENGTH_FOR_INS);
+            struct transaction_intent_wire const *const transaction = (struct transaction_intent_wire const *)rest;
+            out->tag = OPERATION_TAG_BABYLON_TRANSACTION;
+            out->amount = READ_UNALIGNED_BIG_ENDIAN(uint64_t, &transaction->amount);
+            if (transaction->destination.originated == 0) {
+                parse_implicit_contract(&out->destination, &transaction->destination.u.implicit);
+            } else if (transaction->destination.originated == 1) {
+                out->destination.originated = 1;
+                out->destination.signature_type = SIGNATURE_TYPE_UNSET;
+                memcpy(out->destination.hash, transaction->destination.u.originated.pkh, sizeof(out->destination.hash));
+            } else {
+                THROW(EXC_WRONG_VALUES);
+            }
+            break;
+        }
+        case OPERATION_TAG_BABYLON_DELEGATION:
+            out->tag = OPERATION_TAG_BABYLON_DELEGATION;
+            if (rest_size == sizeof(struct implicit_contract)) {
+                parse_implicit_contract(&out->destination, (struct implicit_contract const *)rest);
+            } else if (rest_size != 0) { // No delegate: withdraw the delegation
+                THROW(EXC_WRONG_LENGTH_FOR_INS);
+            }
+            break;
+        default:
+            THROW(EXC_WRONG_PARAM);
+    }
+}
+
+static size_t forge_byte(uint8_t *const out, size_t const out_size, size_t ix, uint8_t const byte) {
+    if (ix >= out_size) THROW(EXC_WRONG_LENGTH);
+    out[ix++] = byte;
+    return ix;
+}
+
+static size_t forge_bytes(uint8_t *const out, size_t const out_size, size_t ix, uint8_t const *const in, size_t const in_size) {
+    if (out_size - ix < in_size) THROW(EXC_WRONG_LENGTH);
+    memcpy(out + ix, in, in_size);
+    return ix + in_size;
+}
+
+// Zarith natural: seven bits per byte, least significant first, high bit set on all but the last byte.
+static size_t forge_zarith(uint8_t *const out, size_t const out_size, size_t ix, uint64_t value) {
+    while (value >= 0x80) {
+        ix = forge_byte(out, out_size, ix, 0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+    return forge_byte(out, out_size, ix, value);
+}
+
+static size_t forge_implicit_contract(uint8_t *const out, size_t const out_size, size_t ix, parsed_contract_t const *const in) {
+    ix = forge_byte(out, out_size, ix, unparse_signature_type(in->signature_type));
+    return forge_bytes(out, out_size, ix, in->hash, sizeof(in->hash));
+}
+
+static size_t forge_contract(uint8_t *const out, size_t const out_size, size_t ix, parsed_contract_t const *const in) {
+    ix = forge_byte(out, out_size, ix, in->originated);
+    if (in->originated == 0) return forge_implicit_contract(out, out_size, ix, in);
+    ix = forge_bytes(out, out_size, ix, in->hash, sizeof(in->hash));
+    return forge_byte(out, out_size, ix, 0); // Padding
+}
+
+size_t forge_transfer_intent(uint8_t *const out, size_t const out_size, transfer_intent_t const *const intent) {
+    check_null(out);
+    check_null(intent);
+
+    size_t ix = 0;
+    ix = forge_byte(out, out_size, ix, MAGIC_BYTE_UNSAFE_OP);
+    ix = forge_bytes(out, out_size, ix, intent->branch, sizeof(intent->branch));
+
+    ix = forge_byte(out, out_size, ix, intent->tag);
+    ix = forge_implicit_contract(out, out_size, ix, &intent->source);
+    ix = forge_zarith(out, out_size, ix, intent->fee);
+    ix = forge_zarith(out, out_size, ix, intent->counter);
+    ix = forge_zarith(out, out_size, ix, intent->gas_limit);
+    ix = forge_zarith(out, out_size, ix, intent->storage_limit);
+
+    switch (intent->tag) {
+        case OPERATION_TAG_BABYLON_TRANSACTION:
+            ix = forge_zarith(out, out_size, ix, intent->amount);
+            ix = forge_contract(out, out_size, ix, &intent->destination);
+            return forge_byte(out, out_size, ix, 0); // No parameters
+        case OPERATION_TAG_BABYLON_DELEGATION:
+            if (intent->destination.signature_type == SIGNATURE_TYPE_UNSET) {
+                return forge_byte(out, out_size, ix, 0);
+            }
+            ix = forge_byte(out, out_size, ix, 0xFF);
+            return forge_implicit_contract(out, out_size, ix, &intent->destination);
+        default:
+            THROW(EXC_WRONG_PARAM);
+    }
+}
+
+#endif // #ifdef WALLET_APP
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifdef WALLET_APP
+
+#include "os_cx.h"
+#include "types.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OPERATION_BRANCH_SIZE 32
+
+// Magic byte, branch, and one transaction with every Zarith field at its longest.
+#define MAX_FORGED_INTENT_SIZE 128
+
+// A single Babylon transaction or delegation, described by the host instead of forged by it.
+typedef struct {
+    uint8_t branch[OPERATION_BRANCH_SIZE];
+    enum operation_tag tag; // OPERATION_TAG_BABYLON_TRANSACTION or OPERATION_TAG_BABYLON_DELEGATION
+    parsed_contract_t source;
+    parsed_contract_t destination; // The delegate of a delegation; unset for a withdrawal
+    uint64_t fee;
+    uint64_t counter;
+    uint64_t gas_limit;
+    uint64_t storage_limit;
+    uint64_t amount; // Transactions only
+} transfer_intent_t;
+
+// Reads the wire form of an intent (everything after the key path); `source` is left unset.
+// Throws on malformed input.
+void parse_transfer_intent(transfer_intent_t *const out, uint8_t const *const in, size_t const in_size);
+
+// Writes the operation group `intent` describes, magic byte first, and returns its size.
+size_t forge_transfer_intent(uint8_t *const out, size_t const out_size, transfer_intent_t const *const intent);
+
+#endif // #ifdef WALLET_APP
@@ -32,6 +32,11 @@ unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 
 void clear_apdu_globals(void) {
     memset(&global.apdu, 0, sizeof(global.apdu));
+    if (global.sign_sessions.active != NULL) {
+        memset(global.sign_sessions.active, 0, sizeof(*global.sign_sessions.active));
+        global.sign_sessions.active = NULL;
+    }
+    global.scratch.used = 0; // Whatever held scratch space was unwound by the exception
 }
 
 void init_globals(void) {
@@ -47,6 +52,11 @@ void init_globals(void) {
     memset(G_io_seproxyhal_spi_buffer, 0, sizeof(G_io_seproxyhal_spi_buffer));
 }
 
+#if !defined(BAKING_APP) && !defined(TARGET_NANOX)
+// DO NOT TRY TO INIT THIS. See N_data_real below.
+wallet_settings_t N_wallet_settings_real;
+#endif
+
 #ifdef BAKING_APP
 
 // DO NOT TRY TO INIT THIS. This can only be written via an system call.
@@ -76,13 +86,9 @@ void calculate_baking_idle_screens_data(void) {
 
     if (N_data.baking_key.bip32_path.length == 0) {
         STRCPY(global.ui.baking_idle_screens.pkh, "No Key Authorized");
-    } else {
-        cx_ecfp_public_key_t const *const pubkey = generate_public_key_return_global(
-            (derivation_type_t const)N_data.baking_key.derivation_type,
-            (bip32_path_t const *const)&N_data.baking_key.bip32_path);
-        pubkey_to_pkh_string(
-            global.ui.baking_idle_screens.pkh, sizeof(global.ui.baking_idle_screens.pkh),
-            (derivation_type_t const)N_data.baking_key.derivation_type, pubkey);
+        memset(&global.ui.baking_idle_screens.pkh_key, 0, sizeof(global.ui.baking_idle_screens.pkh_key));
+    } else if (baking_idle_screens_pkh_pending()) {
+        global.ui.baking_idle_screens.pkh[0] = '\0'; // Never show the hash of a key that is no longer authorized
     }
 
 #   ifdef TARGET_NANOX
@@ -98,6 +104,21 @@ void calculate_baking_idle_screens_data(void) {
 #   ifdef TARGET_NANOX
         }
 #   endif
+
+    global.ui.baking_idle_screens.stale = false;
+}
+
+bool baking_idle_screens_pkh_pending(void) {
+    return N_data.baking_key.bip32_path.length != 0
+        && !bip32_path_with_curve_eq(&global.ui.baking_idle_screens.pkh_key, &N_data.baking_key);
+}
+
+void calculate_baking_idle_screens_pkh(void) {
+    if (!baking_idle_screens_pkh_pending()) return;
+    bip32_path_with_curve_to_pkh_string(
+        global.ui.baking_idle_screens.pkh, sizeof(global.ui.baking_idle_screens.pkh),
+        (bip32_path_with_curve_t const *const)&N_data.baking_key);
+    copy_bip32_path_with_curve(&global.ui.baking_idle_screens.pkh_key, &N_data.baking_key);
 }
 
 void update_baking_idle_screens(void) {
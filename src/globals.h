@@ -1,12 +1,14 @@
 #pragma once
 
+#include "blake2b.h"
+#include "forge.h"
 #include "types.h"
 
 #include "bolos_target.h"
 
 #include "operations.h"
 
-// Zeros out all globals that can keep track of APDU instruction state.
+// Zeros out all globals that can keep track of APDU instruction state, and releases the scratch arena.
 // Notably this does *not* include UI state.
 void clear_apdu_globals(void);
 
@@ -19,11 +21,27 @@ void init_globals(void);
 #define TEZOS_BUFSIZE (BLAKE2B_BLOCKBYTES + MAX_APDU_SIZE)
 
 #define PRIVATE_KEY_DATA_SIZE 32
+#define DERIVED_KEY_DATA_SIZE 64 // BIP32-Ed25519 derivation writes an extended key this long
 
 #define MAX_SIGNATURE_SIZE 100
 
+#define SCRATCH_SIZE 288 // Fits a cx_blake2b_t, the largest temporary (see scratch.h)
+
+
+// Sign streams that can be in flight at once, each addressed by the session bits of P1.
+// A sign state is about 1.5 KB, which the Nano S only has room for once, inside `global.apdu.u`.
+#ifndef SIGN_SESSION_COUNT
+#   ifdef TARGET_NANOX
+#       define SIGN_SESSION_COUNT 2
+#   else
+#       define SIGN_SESSION_COUNT 1
+#   endif
+#endif
+
+#define LAST_SIGNATURE_TICKS 100 // Ticker events (100ms each) a wallet signature can be resent for
+
 struct priv_generate_key_pair {
-    uint8_t private_key_data[PRIVATE_KEY_DATA_SIZE];
+    uint8_t private_key_data[DERIVED_KEY_DATA_SIZE];
     key_pair_t res;
 };
 
@@ -36,10 +54,7 @@ typedef struct {
 } apdu_hmac_state_t;
 #endif
 
-typedef struct {
-    cx_blake2b_t state;
-    bool initialized;
-} blake2b_hash_state_t;
+#define TICKER_PERIOD_MS 100
 
 typedef struct {
     bip32_path_with_curve_t key;
@@ -62,22 +77,58 @@ typedef struct {
     blake2b_hash_state_t hash_state;
     uint8_t final_hash[SIGN_HASH_SIZE];
 
+    struct {
+        bool requested; // Append the trailer to the signature response
+        uint32_t prompt_start_ticks; // `global.ticks` when the prompt was shown
+        uint32_t prompt_start_display_packets; // `global.display_packets` when the prompt was shown
+        uint32_t prompt_ticks; // Ticker events between the prompt being shown and answered
+        uint32_t prompt_display_packets; // Display packets sent in that time
+    } timing;
+
     uint8_t magic_byte;
     bool hash_only;
     struct parse_state parse_state;
+
+#   ifdef WALLET_APP
+    struct {
+        uint8_t bytes[MAX_FORGED_INTENT_SIZE];
+        uint8_t length; // Sent ahead of the signature when not 0
+    } forged_intent;
+#   endif
 } apdu_sign_state_t;
 
+typedef struct {
+    blake2b_hash_state_t hash_state;
+
+    uint8_t message_data[TEZOS_BUFSIZE];
+    size_t message_data_length;
+
+    uint8_t digest_size; // 0 when no stream is in progress
+} apdu_hash_state_t;
+
 typedef struct {
   void *stack_root;
-  apdu_handler handlers[INS_MAX + 1];
+
+  uint32_t ticks; // Ticker events since the app started
+  uint32_t display_packets; // Elements sent to the screen since the app started
+  uint8_t continuation_tokens; // Last token handed out by `start_continuation`
+
+  struct {
+      uint8_t bytes[SCRATCH_SIZE] __attribute__((aligned(8)));
+      size_t used;
+      size_t peak; // Most bytes ever in use at once
+  } scratch;
 
   struct {
     ui_callback_t ok_callback;
     ui_callback_t cxl_callback;
 
+    bool initial_screen_pending; // Shown by the first ticker event instead of at boot
+
 #   ifndef TARGET_NANOX
     uint32_t ux_step;
     uint32_t ux_step_count;
+    uint32_t seen_screens; // Bit mask of the prompt screens displayed so far
 
     uint32_t timeout_cycle_count;
 #   endif
@@ -87,6 +138,9 @@ typedef struct {
         char hwm[MAX_INT_DIGITS + 1]; // with null termination
         char pkh[PKH_STRING_SIZE];
         char chain[CHAIN_ID_BASE58_STRING_SIZE];
+
+        bool stale; // N_data changed since these were computed
+        bip32_path_with_curve_t pkh_key; // Key `pkh` was derived from
     } baking_idle_screens;
 #   endif
 
@@ -116,7 +170,17 @@ typedef struct {
               cx_ecfp_public_key_t public_key;
           } pubkey;
 
+#         if SIGN_SESSION_COUNT == 1
           apdu_sign_state_t sign;
+#         endif
+
+          apdu_hash_state_t hash;
+
+          struct {
+              bip32_path_with_curve_t key; // Next key to hash
+              uint16_t remaining;
+              cx_ecfp_public_key_t public_key;
+          } pkh_scan;
 
 #         ifdef BAKING_APP
           struct {
@@ -145,17 +209,49 @@ typedef struct {
 #     endif
 
       struct {
-          struct priv_generate_key_pair generate_key_pair;
+          continuation_step step; // NULL when no long command is in progress
+          uint8_t token;
+      } continuation;
 
-          struct {
-              cx_ecfp_public_key_t compressed;
-          } public_key_hash;
+      struct {
+          struct priv_generate_key_pair generate_key_pair;
       } priv;
     } apdu;
+
+  struct {
+#     if SIGN_SESSION_COUNT > 1
+      // Outside `apdu` so other instructions, and errors in other sessions, leave a stream alone.
+      apdu_sign_state_t slots[SIGN_SESSION_COUNT];
+#     endif
+      apdu_sign_state_t *active; // Session of the current sign request; NULL outside of one
+      apdu_sign_state_t *prompted; // Session whose operation was last put on screen
+      bool prompted_overwritten; // Nano S: another APDU reused the session while it was on screen
+  } sign_sessions;
+
+# ifdef WALLET_APP
+  // Last approved signature, so a reply lost in transport can be sent again without a new prompt.
+  // Lives outside `apdu` because errors clear that.
+  struct {
+      bip32_path_with_curve_t key;
+      uint8_t final_hash[SIGN_HASH_SIZE];
+      uint8_t signature[MAX_SIGNATURE_SIZE];
+      size_t signature_length;
+      uint32_t ticks_left; // 0 when there is nothing to resend
+  } last_signature;
+# endif
 } globals_t;
 
 extern globals_t global;
 
+// Sign state of the session the current request addresses.
+#define SIGN_SESSION (*global.sign_sessions.active)
+
+#if SIGN_SESSION_COUNT > 1
+#   define SIGN_SESSION_SLOT(session) (&global.sign_sessions.slots[session])
+#else
+#   define SIGN_SESSION_SLOT(session) (&global.apdu.u.sign)
+#endif
+
 extern unsigned int app_stack_canary; // From SDK
 
 // Used by macros that we don't control.
@@ -174,6 +270,28 @@ static inline void throw_stack_size() {
     THROW(0x9000 + tmp2);
 }
 
+#ifdef WALLET_APP
+// Called on every ticker event. Forgets the last signature once its resend window is over.
+static inline void age_last_signature(void) {
+    if (global.last_signature.ticks_left != 0 && --global.last_signature.ticks_left == 0) {
+        explicit_bzero(&global.last_signature, sizeof(global.last_signature));
+    }
+}
+#endif
+
+#if !defined(BAKING_APP) && !defined(TARGET_NANOX)
+    extern wallet_settings_t N_wallet_settings_real;
+#   define N_wallet_settings (*(wallet_settings_t*)PIC(&N_wallet_settings_real))
+
+#   define UPDATE_WALLET_SETTINGS(out_name, body) ({ \
+        wallet_settings_t new_wallet_settings; \
+        wallet_settings_t *const out_name = &new_wallet_settings; \
+        memcpy(&new_wallet_settings, (wallet_settings_t const *const)&N_wallet_settings, sizeof(new_wallet_settings)); \
+        body; \
+        nvm_write((void*)&N_wallet_settings, &new_wallet_settings, sizeof(N_wallet_settings)); \
+    })
+#endif
+
 #ifdef BAKING_APP
 #   ifdef TARGET_NANOX
         extern nvram_data const N_data_real;
@@ -183,7 +301,11 @@ static inline void throw_stack_size() {
 #       define N_data (*(nvram_data*)PIC(&N_data_real))
 #    endif
 
+// Idle screen data is only recomputed when `stale`. The baking key hash takes a key derivation, so
+// it is left out of that and filled in by a later ticker event, once the key changed.
 void calculate_baking_idle_screens_data(void);
+bool baking_idle_screens_pkh_pending(void);
+void calculate_baking_idle_screens_pkh(void);
 void update_baking_idle_screens(void);
 high_watermark_t volatile *select_hwm_by_chain(chain_id_t const chain_id, nvram_data volatile *const ram);
 
@@ -195,6 +317,6 @@ high_watermark_t volatile *select_hwm_by_chain(chain_id_t const chain_id, nvram_
     memcpy(&global.apdu.baking_auth.new_data, (nvram_data const *const)&N_data, sizeof(global.apdu.baking_auth.new_data)); \
     body; \
     nvm_write((void*)&N_data, &global.apdu.baking_auth.new_data, sizeof(N_data)); \
-    update_baking_idle_screens(); \
+    global.ui.baking_idle_screens.stale = true; \
 })
 #endif
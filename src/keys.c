@@ -21,6 +21,7 @@
 #include "globals.h"
 #include "memory.h"
 #include "protocol.h"
+#include "scratch.h"
 #include "types.h"
 
 #include <stdbool.h>
@@ -44,29 +45,39 @@ size_t read_bip32_path(bip32_path_t *const out, uint8_t const *const in, size_t
     return ix;
 }
 
-key_pair_t *generate_key_pair_return_global(
+static cx_curve_t derive_private_key_data(
+    uint8_t private_key_data[DERIVED_KEY_DATA_SIZE],
     derivation_type_t const derivation_type,
     bip32_path_t const *const bip32_path
 ) {
-    check_null(bip32_path);
-    struct priv_generate_key_pair *const priv = &global.apdu.priv.generate_key_pair;
-
     cx_curve_t const cx_curve = signature_type_to_cx_curve(derivation_type_to_signature_type(derivation_type));
+    if (cx_curve == CX_CURVE_NONE) THROW(EXC_WRONG_PARAM);
 
     if (derivation_type == DERIVATION_TYPE_ED25519) {
         // Old, non BIP32_Ed25519 way...
         os_perso_derive_node_bip32_seed_key(
             HDW_ED25519_SLIP10, CX_CURVE_Ed25519, bip32_path->components, bip32_path->length,
-            priv->private_key_data, NULL, NULL, 0);
+            private_key_data, NULL, NULL, 0);
     } else {
         os_perso_derive_node_bip32(
             cx_curve, bip32_path->components, bip32_path->length,
-            priv->private_key_data, NULL);
+            private_key_data, NULL);
     }
+    return cx_curve;
+}
+
+key_pair_t *generate_key_pair_return_global(
+    derivation_type_t const derivation_type,
+    bip32_path_t const *const bip32_path
+) {
+    check_null(bip32_path);
+    struct priv_generate_key_pair *const priv = &global.apdu.priv.generate_key_pair;
+
+    cx_curve_t const cx_curve = derive_private_key_data(priv->private_key_data, derivation_type, bip32_path);
 
     BEGIN_TRY {
         TRY {
-            cx_ecfp_init_private_key(cx_curve, priv->private_key_data, sizeof(priv->private_key_data), &priv->res.private_key);
+            cx_ecfp_init_private_key(cx_curve, priv->private_key_data, PRIVATE_KEY_DATA_SIZE, &priv->res.private_key);
             cx_ecfp_generate_pair(cx_curve, &priv->res.public_key, &priv->res.private_key, 1);
 
             if (cx_curve == CX_CURVE_Ed25519) {
@@ -94,39 +105,58 @@ cx_ecfp_public_key_t const *generate_public_key_return_global(
     return &pair->public_key;
 }
 
-cx_ecfp_public_key_t const *public_key_hash_return_global(
-    uint8_t *const out, size_t const out_size,
-    derivation_type_t const curve,
-    cx_ecfp_public_key_t const *const restrict public_key)
-{
+void generate_compressed_public_key(
+    cx_ecfp_public_key_t *const out,
+    derivation_type_t const derivation_type,
+    bip32_path_t const *const bip32_path
+) {
     check_null(out);
-    check_null(public_key);
-    if (out_size < HASH_SIZE) THROW(EXC_WRONG_LENGTH);
+    check_null(bip32_path);
 
-    cx_ecfp_public_key_t *const compressed = &global.apdu.priv.public_key_hash.compressed;
-    switch (derivation_type_to_signature_type(curve)) {
-        case SIGNATURE_TYPE_ED25519:
-            {
-                compressed->W_len = public_key->W_len - 1;
-                memcpy(compressed->W, public_key->W + 1, compressed->W_len);
-                break;
-            }
-        case SIGNATURE_TYPE_SECP256K1:
-        case SIGNATURE_TYPE_SECP256R1:
-            {
-                memcpy(compressed->W, public_key->W, public_key->W_len);
-                compressed->W[0] = 0x02 + (public_key->W[64] & 0x01);
-                compressed->W_len = 33;
-                break;
+    // In scratch rather than on the stack: the key scan derives one account after another.
+    typedef struct {
+        uint8_t private_key_data[DERIVED_KEY_DATA_SIZE];
+        cx_ecfp_private_key_t private_key;
+    } derivation_t;
+
+    cx_curve_t const cx_curve = signature_type_to_cx_curve(derivation_type_to_signature_type(derivation_type));
+    WITH_SCRATCH(derivation_t, derivation, ({
+        BEGIN_TRY {
+            TRY {
+                derive_private_key_data(derivation->private_key_data, derivation_type, bip32_path);
+                cx_ecfp_init_private_key(cx_curve, derivation->private_key_data, PRIVATE_KEY_DATA_SIZE,
+                                         &derivation->private_key);
+                cx_ecfp_generate_pair(cx_curve, out, &derivation->private_key, 1);
+            } FINALLY {
+                explicit_bzero(derivation, sizeof(*derivation));
             }
-        default:
-            THROW(EXC_WRONG_PARAM);
+        }
+        END_TRY;
+    }));
+
+    if (cx_curve == CX_CURVE_Ed25519) {
+        cx_edward_compress_point(CX_CURVE_Ed25519, out->W, out->W_len);
+        // Drop the 0x02 prefix the SDK puts in front of the compressed point.
+        out->W_len = 32;
+        memmove(out->W, out->W + 1, out->W_len);
+    } else {
+        out->W[0] = 0x02 + (out->W[64] & 0x01);
+        out->W_len = 33;
     }
+}
+
+void compressed_public_key_hash(
+    uint8_t *const out, size_t const out_size,
+    cx_ecfp_public_key_t const *const compressed
+) {
+    check_null(out);
+    check_null(compressed);
+    if (out_size < HASH_SIZE) THROW(EXC_WRONG_LENGTH);
 
-    cx_blake2b_t hash_state;
-    cx_blake2b_init(&hash_state, HASH_SIZE*8); // cx_blake2b_init takes size in bits.
-    cx_hash((cx_hash_t *) &hash_state, CX_LAST, compressed->W, compressed->W_len, out, HASH_SIZE);
-    return compressed;
+    WITH_SCRATCH(cx_blake2b_t, hash_state, ({
+        cx_blake2b_init(hash_state, HASH_SIZE*8); // cx_blake2b_init takes size in bits.
+        cx_hash((cx_hash_t *) hash_state, CX_LAST, compressed->W, compressed->W_len, out, HASH_SIZE);
+    }));
 }
 
 size_t sign(
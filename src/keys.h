@@ -55,25 +55,17 @@ static inline void generate_public_key(
     memcpy(out, result, sizeof(*out));
 }
 
-// Non-reentrant
-cx_ecfp_public_key_t const *public_key_hash_return_global(
-    uint8_t *const out, size_t const out_size,
+// Derives the public key for `bip32_path` in the compressed form Tezos hashes and reveals:
+// the 32-byte point for Ed25519, or the 33-byte compressed point for secp256k1 and secp256r1.
+void generate_compressed_public_key(
+    cx_ecfp_public_key_t *const out,
     derivation_type_t const derivation_type,
-    cx_ecfp_public_key_t const *const restrict public_key);
+    bip32_path_t const *const bip32_path);
 
-// Non-reentrant
-static inline void public_key_hash(
-    uint8_t *const hash_out, size_t const hash_out_size,
-    cx_ecfp_public_key_t *const pubkey_out, // pass NULL if this value is not desired
-    derivation_type_t const derivation_type,
-    cx_ecfp_public_key_t const *const restrict public_key
-) {
-    cx_ecfp_public_key_t const *const pubkey = public_key_hash_return_global(
-        hash_out, hash_out_size, derivation_type, public_key);
-    if (pubkey_out != NULL) {
-        memcpy(pubkey_out, pubkey, sizeof(*pubkey_out));
-    }
-}
+// Hashes a key from `generate_compressed_public_key` into a public key hash.
+void compressed_public_key_hash(
+    uint8_t *const out, size_t const out_size,
+    cx_ecfp_public_key_t const *const compressed);
 
 size_t sign(
     uint8_t *const out, size_t const out_size,
@@ -1,4 +1,5 @@
 #include "apdu_baking.h"
+#include "apdu_hash.h"
 #include "apdu_hmac.h"
 #include "apdu_pubkey.h"
 #include "apdu_setup.h"
@@ -7,30 +8,35 @@
 #include "globals.h"
 #include "memory.h"
 
-__attribute__((noreturn))
-void app_main(void) {
-    // TODO: Consider using static initialization of a const, instead of this
-    for (size_t i = 0; i < NUM_ELEMENTS(global.handlers); i++) {
-        global.handlers[i] = handle_apdu_error;
-    }
-    global.handlers[APDU_INS(INS_VERSION)] = handle_apdu_version;
-    global.handlers[APDU_INS(INS_GET_PUBLIC_KEY)] = handle_apdu_get_public_key;
-    global.handlers[APDU_INS(INS_PROMPT_PUBLIC_KEY)] = handle_apdu_get_public_key;
-    global.handlers[APDU_INS(INS_SIGN)] = handle_apdu_sign;
-    global.handlers[APDU_INS(INS_GIT)] = handle_apdu_git;
-    global.handlers[APDU_INS(INS_SIGN_WITH_HASH)] = handle_apdu_sign_with_hash;
+// Designated initializers beyond INS_MAX do not compile, so every instruction fits the table.
+static apdu_handler const handlers[INS_MAX + 1] = {
+    [INS_VERSION] = handle_apdu_version,
+    [INS_GET_PUBLIC_KEY] = handle_apdu_get_public_key,
+    [INS_PROMPT_PUBLIC_KEY] = handle_apdu_get_public_key,
+    [INS_SIGN] = handle_apdu_sign,
+    [INS_GIT] = handle_apdu_git,
+    [INS_SIGN_WITH_HASH] = handle_apdu_sign_with_hash,
+    [INS_HASH] = handle_apdu_hash,
+    [INS_CONTINUE] = handle_apdu_continue,
+    [INS_SCAN_PUBLIC_KEY_HASHES] = handle_apdu_scan_public_key_hashes,
 #ifdef BAKING_APP
-    global.handlers[APDU_INS(INS_AUTHORIZE_BAKING)] = handle_apdu_get_public_key;
-    global.handlers[APDU_INS(INS_RESET)] = handle_apdu_reset;
-    global.handlers[APDU_INS(INS_QUERY_AUTH_KEY)] = handle_apdu_query_auth_key;
-    global.handlers[APDU_INS(INS_QUERY_MAIN_HWM)] = handle_apdu_main_hwm;
-    global.handlers[APDU_INS(INS_SETUP)] = handle_apdu_setup;
-    global.handlers[APDU_INS(INS_QUERY_ALL_HWM)] = handle_apdu_all_hwm;
-    global.handlers[APDU_INS(INS_DEAUTHORIZE)] = handle_apdu_deauthorize;
-    global.handlers[APDU_INS(INS_QUERY_AUTH_KEY_WITH_CURVE)] = handle_apdu_query_auth_key_with_curve;
-    global.handlers[APDU_INS(INS_HMAC)] = handle_apdu_hmac;
-#else
-    global.handlers[APDU_INS(INS_SIGN_UNSAFE)] = handle_apdu_sign;
+    [INS_AUTHORIZE_BAKING] = handle_apdu_get_public_key,
+    [INS_RESET] = handle_apdu_reset,
+    [INS_QUERY_AUTH_KEY] = handle_apdu_query_auth_key,
+    [INS_QUERY_MAIN_HWM] = handle_apdu_main_hwm,
+    [INS_SETUP] = handle_apdu_setup,
+    [INS_QUERY_ALL_HWM] = handle_apdu_all_hwm,
+    [INS_DEAUTHORIZE] = handle_apdu_deauthorize,
+    [INS_QUERY_AUTH_KEY_WITH_CURVE] = handle_apdu_query_auth_key_with_curve,
+    [INS_HMAC] = handle_apdu_hmac,
+#endif
+#ifdef WALLET_APP
+    [INS_SIGN_UNSAFE] = handle_apdu_sign,
+    [INS_SIGN_INTENT] = handle_apdu_sign_intent,
 #endif
-    main_loop(global.handlers, sizeof(global.handlers));
+};
+
+__attribute__((noreturn))
+void app_main(void) {
+    main_loop(handlers, NUM_ELEMENTS(handlers));
 }
@@ -20,7 +20,7 @@ static void parse_error(
 #endif
     uint32_t lineno) {
 
-    global.apdu.u.sign.parse_state.op_step=STEP_HARD_FAIL;
+    SIGN_SESSION.parse_state.op_step=STEP_HARD_FAIL;
 #ifdef TEZOS_DEBUG
     THROW(0x9000 + lineno);
 #else
@@ -53,11 +53,8 @@ static inline void compute_pkh(
     check_null(bip32_path);
     check_null(compressed_pubkey_out);
     check_null(contract_out);
-    cx_ecfp_public_key_t const *const pubkey = generate_public_key_return_global(derivation_type, bip32_path);
-    public_key_hash(
-        contract_out->hash, sizeof(contract_out->hash),
-        compressed_pubkey_out,
-        derivation_type, pubkey);
+    generate_compressed_public_key(compressed_pubkey_out, derivation_type, bip32_path);
+    compressed_public_key_hash(contract_out->hash, sizeof(contract_out->hash), compressed_pubkey_out);
     contract_out->signature_type = derivation_type_to_signature_type(derivation_type);
     if (contract_out->signature_type == SIGNATURE_TYPE_UNSET) THROW(EXC_MEMORY_ERROR);
     contract_out->originated = 0;
@@ -96,6 +93,14 @@ static inline void parse_contract(parsed_contract_t *const out, struct contract
 
 #define NEXT_BYTE (byte)
 
+// Adds 7 (or fewer) bits of a Zarith number at the current shift, refusing any bit that would be
+// shifted out of 64 bits instead of silently dropping it.
+static inline void accumulate_z_bits(struct int_subparser_state *const state, uint64_t const bits) {
+  if (state->shift >= 64) PARSE_ERROR();
+  if (state->shift > 64 - 7 && (bits >> (64 - state->shift)) != 0) PARSE_ERROR();
+  state->value |= bits << state->shift;
+}
+
 static inline bool parse_z(uint8_t current_byte, struct int_subparser_state *state, uint32_t lineno) {
   if(state->lineno != lineno) {
       // New call; initialize.
@@ -103,12 +108,19 @@ static inline bool parse_z(uint8_t current_byte, struct int_subparser_state *sta
       state->value = 0;
       state->shift = 0;
   }
-  state->value |= ((uint64_t)current_byte & 0x7F) << state->shift;
+  accumulate_z_bits(state, current_byte & 0x7F);
   state->shift += 7;
   return current_byte & 0x80; // Return true if we need more bytes.
 }
 
+// Mutez are int64 on chain, so anything above INT64_MAX can never be a valid amount.
+static inline uint64_t mutez_or_fail(uint64_t const value) {
+  if (value > INT64_MAX) PARSE_ERROR();
+  return value;
+}
+
 #define PARSE_Z ({CALL_SUBPARSER(parse_z, (byte), &(state)->subparser_state.integer); (state)->subparser_state.integer.value;})
+#define PARSE_Z_MUTEZ ({CALL_SUBPARSER(parse_z, (byte), &(state)->subparser_state.integer); mutez_or_fail((state)->subparser_state.integer.value);})
 
 // Only used through the macro
 static inline bool parse_z_michelson(uint8_t current_byte, struct int_subparser_state *state, uint32_t lineno) {
@@ -118,18 +130,19 @@ static inline bool parse_z_michelson(uint8_t current_byte, struct int_subparser_
       state->value = 0;
       state->shift = 0;
   }
-  state->value |= ((uint64_t)current_byte & 0x7F) << state->shift;
-  // For some reason we are getting numbers shifted 1 bit to the
-  // left. TODO: figure out why this happens
+  // Micheline integers are signed: the first byte carries a sign bit and only 6 bits of the value.
   if (state->shift == 0) {
+      if (current_byte & 0x40) PARSE_ERROR(); // We never display negative amounts.
+      accumulate_z_bits(state, current_byte & 0x3F);
       state->shift += 6;
   } else {
+      accumulate_z_bits(state, current_byte & 0x7F);
       state->shift += 7;
   }
   return current_byte & 0x80; // Return true if we need more bytes.
 }
 
-#define PARSE_Z_MICHELSON ({CALL_SUBPARSER(parse_z_michelson, (byte), (&state->subparser_state.integer)); state->subparser_state.integer.value;})
+#define PARSE_Z_MICHELSON_MUTEZ ({CALL_SUBPARSER(parse_z_michelson, (byte), (&state->subparser_state.integer)); mutez_or_fail(state->subparser_state.integer.value);})
 
 static inline bool parse_next_type(uint8_t current_byte, struct nexttype_subparser_state *state, uint32_t sizeof_type, uint32_t lineno) {
     #ifdef DEBUG
@@ -514,7 +527,7 @@ static inline bool parse_byte(
                 switch(state->op_step) {
                     case STEP_OP_TYPE_DISPATCH:
 
-                        out->operation.amount = PARSE_Z;
+                        out->operation.amount = PARSE_Z_MUTEZ;
 
                     OP_STEP {
                         const struct contract *destination = NEXT_TYPE(struct contract);
@@ -538,7 +551,7 @@ static inline bool parse_byte(
                         memcpy(&out->operation.source, &out->operation.destination, sizeof(parsed_contract_t));
 
                         // manager.tz operations cannot actually transfer any amount.
-                        if (out->operation.amount > 0) {
+                        if (out->operation.amount != 0) {
                             PARSE_ERROR();
                         }
                     }
@@ -662,7 +675,7 @@ static inline bool parse_byte(
 
                     OP_STEP
 
-                        out->operation.amount = PARSE_Z_MICHELSON;
+                        out->operation.amount = PARSE_Z_MICHELSON_MUTEZ;
 
                     OP_STEP
 
@@ -746,7 +759,7 @@ static inline bool parse_byte(
                     OP_STEP_REQUIRE_BYTE(0);
 
                     {
-                        out->operation.amount = PARSE_Z_MICHELSON;
+                        out->operation.amount = PARSE_Z_MICHELSON_MUTEZ;
                     }
 
                     OP_STEP
@@ -797,7 +810,7 @@ static inline bool parse_byte(
     PARSE_ERROR(); // Probably not reachable, but removes a warning.
 }
 
-#define G global.apdu.u.sign
+#define G SIGN_SESSION
 #ifdef BAKING_APP
 
 static void parse_operations_throws_parse_error(
@@ -848,7 +861,9 @@ bool parse_operations(
     return true;
 }
 
-#else
+#endif
+
+#ifdef WALLET_APP
 
 bool parse_operations_packet(
     struct parsed_operation_group *const out,
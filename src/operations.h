@@ -62,7 +62,7 @@ typedef struct {
 
 struct int_subparser_state {
 	uint32_t lineno; // Has to be in _all_ members of the subparser union.
-	uint64_t value; // Still need to fix this.
+	uint64_t value;
 	uint8_t shift;
 };
 
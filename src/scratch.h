@@ -0,0 +1,46 @@
+#pragma once
+
+#include "exception.h"
+#include "globals.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Stack-like arena in `global.scratch` for temporaries that would otherwise sit on the stack.
+// Space is released in the reverse order it was acquired; releasing a pointer also releases
+// everything acquired after it. WITH_SCRATCH releases its space even when its body throws, since
+// some exceptions are caught inside the app; clear_apdu_globals also resets the whole arena.
+
+#define SCRATCH_ALIGNMENT 8
+
+static inline void *scratch_acquire(size_t const size) {
+    size_t const aligned_size = (size + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+    if (aligned_size > sizeof(global.scratch.bytes) - global.scratch.used) THROW(EXC_MEMORY_ERROR);
+
+    void *const out = &global.scratch.bytes[global.scratch.used];
+    global.scratch.used += aligned_size;
+    if (global.scratch.used > global.scratch.peak) global.scratch.peak = global.scratch.used;
+    return out;
+}
+
+static inline void scratch_release(void const *const ptr) {
+    size_t const offset = (uint8_t const *)ptr - global.scratch.bytes;
+    if (offset > global.scratch.used) THROW(EXC_MEMORY_ERROR);
+    global.scratch.used = offset;
+}
+
+// Runs `body` with `name` pointing to scratch space for a `type`. `body` must not return or jump
+// out of the block, but may throw. At most one per function, as the try block is labelled.
+#define WITH_SCRATCH(type, name, body) ({ \
+    _Static_assert(sizeof(type) <= SCRATCH_SIZE, #type " does not fit in the scratch arena"); \
+    type *const name = (type *)scratch_acquire(sizeof(type)); \
+    BEGIN_TRY_L(scratch) { \
+        TRY_L(scratch) { \
+            body; \
+        } \
+        FINALLY_L(scratch) { \
+            scratch_release(name); \
+        } \
+    } \
+    END_TRY_L(scratch); \
+})
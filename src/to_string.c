@@ -4,6 +4,7 @@
 #include "base58.h"
 #include "keys.h"
 #include "delegates.h"
+#include "scratch.h"
 
 #include <string.h>
 
@@ -64,20 +65,6 @@ void lookup_parsed_contract_name(
     strcpy(buff, NO_CONTRACT_NAME_STRING);
 }
 
-void pubkey_to_pkh_string(
-    char *const out,
-    size_t const out_size,
-    derivation_type_t const derivation_type,
-    cx_ecfp_public_key_t const *const public_key
-) {
-    check_null(out);
-    check_null(public_key);
-
-    uint8_t hash[HASH_SIZE];
-    public_key_hash(hash, sizeof(hash), NULL, derivation_type, public_key);
-    pkh_to_string(out, out_size, derivation_type_to_signature_type(derivation_type), hash);
-}
-
 void bip32_path_with_curve_to_pkh_string(
     char *const out, size_t const out_size,
     bip32_path_with_curve_t const *const key
@@ -85,17 +72,22 @@ void bip32_path_with_curve_to_pkh_string(
     check_null(out);
     check_null(key);
 
-    cx_ecfp_public_key_t const *const pubkey = generate_public_key_return_global(
-        key->derivation_type, &key->bip32_path);
-    pubkey_to_pkh_string(out, out_size, key->derivation_type, pubkey);
+    cx_ecfp_public_key_t pubkey;
+    generate_compressed_public_key(&pubkey, key->derivation_type, &key->bip32_path);
+
+    uint8_t hash[HASH_SIZE];
+    compressed_public_key_hash(hash, sizeof(hash), &pubkey);
+    pkh_to_string(out, out_size, derivation_type_to_signature_type(key->derivation_type), hash);
 }
 
 
 void compute_hash_checksum(uint8_t out[TEZOS_HASH_CHECKSUM_SIZE], void const *const data, size_t size) {
-    uint8_t checksum[CX_SHA256_SIZE];
-    cx_hash_sha256(data, size, checksum, sizeof(checksum));
-    cx_hash_sha256(checksum, sizeof(checksum), checksum, sizeof(checksum));
-    memcpy(out, checksum, TEZOS_HASH_CHECKSUM_SIZE);
+    typedef uint8_t checksum_t[CX_SHA256_SIZE];
+    WITH_SCRATCH(checksum_t, checksum, ({
+        cx_hash_sha256(data, size, *checksum, sizeof(*checksum));
+        cx_hash_sha256(*checksum, sizeof(*checksum), *checksum, sizeof(*checksum));
+        memcpy(out, *checksum, TEZOS_HASH_CHECKSUM_SIZE);
+    }));
 }
 
 void bin_to_base58(
@@ -125,44 +117,46 @@ void pkh_to_string(
     if (buff_size < PKH_STRING_SIZE) THROW(EXC_WRONG_LENGTH);
 
     // Data to encode
-    struct __attribute__((packed)) {
+    typedef struct __attribute__((packed)) {
         uint8_t prefix[3];
         uint8_t hash[HASH_SIZE];
         uint8_t checksum[TEZOS_HASH_CHECKSUM_SIZE];
-    } data;
-
-    // prefix
-    switch (signature_type) {
-        case SIGNATURE_TYPE_UNSET:
-            data.prefix[0] = 2;
-            data.prefix[1] = 90;
-            data.prefix[2] = 121;
-            break;
-        case SIGNATURE_TYPE_ED25519:
-            data.prefix[0] = 6;
-            data.prefix[1] = 161;
-            data.prefix[2] = 159;
-            break;
-        case SIGNATURE_TYPE_SECP256K1:
-            data.prefix[0] = 6;
-            data.prefix[1] = 161;
-            data.prefix[2] = 161;
-            break;
-        case SIGNATURE_TYPE_SECP256R1:
-            data.prefix[0] = 6;
-            data.prefix[1] = 161;
-            data.prefix[2] = 164;
-            break;
-        default:
-            THROW(EXC_WRONG_PARAM); // Should not reach
-    }
+    } pkh_data_t;
+
+    WITH_SCRATCH(pkh_data_t, data, ({
+        // prefix
+        switch (signature_type) {
+            case SIGNATURE_TYPE_UNSET:
+                data->prefix[0] = 2;
+                data->prefix[1] = 90;
+                data->prefix[2] = 121;
+                break;
+            case SIGNATURE_TYPE_ED25519:
+                data->prefix[0] = 6;
+                data->prefix[1] = 161;
+                data->prefix[2] = 159;
+                break;
+            case SIGNATURE_TYPE_SECP256K1:
+                data->prefix[0] = 6;
+                data->prefix[1] = 161;
+                data->prefix[2] = 161;
+                break;
+            case SIGNATURE_TYPE_SECP256R1:
+                data->prefix[0] = 6;
+                data->prefix[1] = 161;
+                data->prefix[2] = 164;
+                break;
+            default:
+                THROW(EXC_WRONG_PARAM); // Should not reach
+        }
 
-    // hash
-    memcpy(data.hash, hash, sizeof(data.hash));
-    compute_hash_checksum(data.checksum, &data, sizeof(data) - sizeof(data.checksum));
+        // hash
+        memcpy(data->hash, hash, sizeof(data->hash));
+        compute_hash_checksum(data->checksum, data, sizeof(*data) - sizeof(data->checksum));
 
-    size_t out_size = buff_size;
-    if (!b58enc(buff, &out_size, &data, sizeof(data))) THROW(EXC_WRONG_LENGTH);
+        size_t out_size = buff_size;
+        if (!b58enc(buff, &out_size, data, sizeof(*data))) THROW(EXC_WRONG_LENGTH);
+    }));
 }
 
 void protocol_hash_to_string(char *buff, const size_t buff_size, const uint8_t hash[PROTOCOL_HASH_SIZE]) {
@@ -171,19 +165,21 @@ void protocol_hash_to_string(char *buff, const size_t buff_size, const uint8_t h
     if (buff_size < PROTOCOL_HASH_BASE58_STRING_SIZE) THROW(EXC_WRONG_LENGTH);
 
     // Data to encode
-    struct __attribute__((packed)) {
+    typedef struct __attribute__((packed)) {
         uint8_t prefix[2];
         uint8_t hash[PROTOCOL_HASH_SIZE];
         uint8_t checksum[TEZOS_HASH_CHECKSUM_SIZE];
-    } data = {
-        .prefix = {2, 170}
-    };
+    } protocol_hash_data_t;
 
-    memcpy(data.hash, hash, sizeof(data.hash));
-    compute_hash_checksum(data.checksum, &data, sizeof(data) - sizeof(data.checksum));
+    WITH_SCRATCH(protocol_hash_data_t, data, ({
+        data->prefix[0] = 2;
+        data->prefix[1] = 170;
+        memcpy(data->hash, hash, sizeof(data->hash));
+        compute_hash_checksum(data->checksum, data, sizeof(*data) - sizeof(data->checksum));
 
-    size_t out_size = buff_size;
-    if (!b58enc(buff, &out_size, &data, sizeof(data))) THROW(EXC_WRONG_LENGTH);
+        size_t out_size = buff_size;
+        if (!b58enc(buff, &out_size, data, sizeof(*data))) THROW(EXC_WRONG_LENGTH);
+    }));
 }
 
 void chain_id_to_string(char *const buff, size_t const buff_size, chain_id_t const chain_id) {
@@ -9,11 +9,6 @@
 #include "types.h"
 #include "ui.h"
 
-void pubkey_to_pkh_string(
-    char *const out, size_t const out_size,
-    derivation_type_t const derivation_type,
-    cx_ecfp_public_key_t const *const public_key
-);
 void bip32_path_with_curve_to_pkh_string(
     char *const out, size_t const out_size,
     bip32_path_with_curve_t const *const key
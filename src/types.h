@@ -42,6 +42,10 @@ typedef enum {
 // Return number of bytes to transmit (tx)
 typedef size_t (*apdu_handler)(uint8_t instruction);
 
+// Writes the output of one bounded chunk of a long command and returns its size.
+// Sets `*done` once the command has no work left. See `start_continuation`.
+typedef size_t (*continuation_step)(uint8_t *const out, size_t const out_size, bool *const done);
+
 typedef uint32_t level_t;
 
 #define CHAIN_ID_BASE58_STRING_SIZE sizeof("NetXdQprcVkpaWU")
@@ -151,6 +155,14 @@ typedef struct {
     bip32_path_with_curve_t baking_key;
 } nvram_data;
 
+// Prompt review preferences of the wallet app on the Nano S.
+typedef struct {
+    uint16_t screen_dwell_ms; // 0 means DEFAULT_SCREEN_DWELL_MS
+    bool fast_review; // Right button pages, both buttons approve once every screen was shown
+} wallet_settings_t;
+
+#define DEFAULT_SCREEN_DWELL_MS 2000
+
 #define SIGN_HASH_SIZE 32 // TODO: Rename or use a different constant.
 
 #define PKH_STRING_SIZE 40 // includes null byte // TODO: use sizeof for this.
@@ -261,12 +273,7 @@ struct parsed_operation_group {
 };
 
 // Maximum number of APDU instructions
-#define INS_MAX 0x0F
-
-#define APDU_INS(x) ({ \
-    _Static_assert(x <= INS_MAX, "APDU instruction is out of bounds"); \
-    x; \
-})
+#define INS_MAX 0x13
 
 #define STRCPY(buff, x) ({ \
     _Static_assert(sizeof(buff) >= sizeof(x) && sizeof(*x) == sizeof(char), "String won't fit in buffer"); \
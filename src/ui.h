@@ -10,6 +10,9 @@
 #define BAGL_SCROLLING_ELEMENT 100 // Arbitrary value chosen to connect data structures with prepro func
 
 void ui_initial_screen(void);
+// Leaves the initial screen to the first ticker event, and the baking key hash to a later one,
+// so the app can answer APDUs as soon as it starts.
+void ui_defer_initial_screen(void);
 void ui_init(void);
 void ui_refresh(void);
 
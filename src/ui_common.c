@@ -6,6 +6,7 @@
 void io_seproxyhal_display(const bagl_element_t *element);
 
 void io_seproxyhal_display(const bagl_element_t *element) {
+    global.display_packets++;
     return io_seproxyhal_display_default((bagl_element_t *)element);
 }
 
@@ -13,6 +14,13 @@ void ui_init(void) {
     UX_INIT();
 }
 
+void ui_defer_initial_screen(void) {
+#   ifdef BAKING_APP
+        global.ui.baking_idle_screens.stale = true;
+#   endif
+    global.ui.initial_screen_pending = true;
+}
+
 void register_ui_callback(uint32_t which, string_generation_callback cb, const void *data) {
     if (which >= MAX_SCREEN_COUNT) THROW(EXC_MEMORY_ERROR);
     global.ui.prompt.callbacks[which] = cb;
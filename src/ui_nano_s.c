@@ -4,6 +4,7 @@
 
 #include "ui.h"
 
+#include "apdu_sign.h"
 #include "baking_auth.h"
 #include "exception.h"
 #include "globals.h"
@@ -47,6 +48,8 @@ static unsigned button_handler(unsigned button_mask, unsigned button_mask_counte
 
 #define PROMPT_CYCLES 3
 
+#define BAGL_CHECK_ELEMENT 101 // Approve icon of prompts, replaced while fast review still has unseen screens
+
 #ifdef BAKING_APP
 static const bagl_element_t ui_idle_screen[] = {
     // type                               userid    x    y   w    h  str rad
@@ -95,7 +98,9 @@ static bool do_nothing(void) {
 
 static void ui_idle(void) {
 #   ifdef BAKING_APP
-        update_baking_idle_screens();
+        if (G.baking_idle_screens.stale) {
+            calculate_baking_idle_screens_data();
+        }
         ui_display(
             ui_idle_screen, NUM_ELEMENTS(ui_idle_screen),
             do_nothing, exit_app, 3);
@@ -106,9 +111,7 @@ static void ui_idle(void) {
 }
 
 void ui_initial_screen(void) {
-#   ifdef BAKING_APP
-        update_baking_idle_screens();
-#   endif
+    G.initial_screen_pending = false;
     clear_ui_callbacks();
     ui_idle();
 }
@@ -117,12 +120,31 @@ static bool is_idling(void) {
     return G.cxl_callback == exit_app;
 }
 
+static uint32_t prompt_dwell_ms(void) {
+#   ifndef BAKING_APP
+        uint16_t const dwell_ms = N_wallet_settings.screen_dwell_ms;
+        if (dwell_ms != 0) return dwell_ms;
+#   endif
+    return DEFAULT_SCREEN_DWELL_MS;
+}
+
+// In fast review, the right button pages through the prompt and both buttons approve it,
+// but only once every screen has been displayed.
+static bool fast_review(void) {
+#   ifdef BAKING_APP
+        return false;
+#   else
+        return N_wallet_settings.fast_review && !is_idling();
+#   endif
+}
+
+static bool all_screens_seen(void) {
+    return G.seen_screens == (1u << G.ux_step_count) - 1;
+}
+
 static void timeout(void) {
     if (is_idling()) {
         // Idle app timeout
-#       ifdef BAKING_APP
-            update_baking_idle_screens();
-#       endif
         G.timeout_cycle_count = 0;
         UX_REDISPLAY();
     } else {
@@ -138,6 +160,17 @@ static unsigned button_handler(unsigned button_mask, __attribute__((unused)) uns
             callback = G.cxl_callback;
             break;
         case BUTTON_EVT_RELEASED | BUTTON_RIGHT:
+            if (fast_review()) {
+                G.ux_step = (G.ux_step + 1) % G.ux_step_count;
+                switch_screen(G.ux_step);
+                G.timeout_cycle_count = 0;
+                UX_REDISPLAY();
+                return 0;
+            }
+            callback = G.ok_callback;
+            break;
+        case BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT:
+            if (!fast_review() || !all_screens_seen()) return 0;
             callback = G.ok_callback;
             break;
         default:
@@ -153,18 +186,23 @@ static unsigned button_handler(unsigned button_mask, __attribute__((unused)) uns
 const bagl_element_t *prepro(const bagl_element_t *element) {
     if (element->component.userid == BAGL_STATIC_ELEMENT) return element;
 
-    static const uint32_t pause_millis = 1500;
-    uint32_t min = 2000;
-    static const uint32_t div = 2;
-
-    if (is_idling()) {
-        min = 4000;
+    if (element->component.userid == BAGL_CHECK_ELEMENT) {
+        if (!fast_review() || all_screens_seen()) return element;
+        static bagl_element_t next_icon;
+        memcpy(&next_icon, element, sizeof(next_icon));
+        next_icon.component.icon_id = BAGL_GLYPH_ICON_RIGHT;
+        return &next_icon;
     }
 
     if (G.ux_step == element->component.userid - 1 || element->component.userid == BAGL_SCROLLING_ELEMENT) {
         // timeouts are in millis
-        UX_CALLBACK_SET_INTERVAL(MAX(min,
-                                     (pause_millis + bagl_label_roundtrip_duration_ms(element, 7)) / div));
+        uint32_t const scroll_millis = bagl_label_roundtrip_duration_ms(element, 7) / 2;
+        if (is_idling()) {
+            UX_CALLBACK_SET_INTERVAL(MAX(4000, 1500 / 2 + scroll_millis));
+        } else {
+            // The dwell is the pause once a value has scrolled into view; it has no floor of its own.
+            UX_CALLBACK_SET_INTERVAL(prompt_dwell_ms() + scroll_millis);
+        }
         return element;
     } else {
         return NULL;
@@ -174,9 +212,11 @@ const bagl_element_t *prepro(const bagl_element_t *element) {
 void ui_display(const bagl_element_t *elems, size_t sz, ui_callback_t ok_c, ui_callback_t cxl_c,
                 uint32_t step_count) {
     // Adapted from definition of UX_DISPLAY in header file
+    G.initial_screen_pending = false;
     G.timeout_cycle_count = 0;
     G.ux_step = 0;
     G.ux_step_count = step_count;
+    G.seen_screens = 0;
     G.ok_callback = ok_c;
     G.cxl_callback = cxl_c;
     if (!is_idling()) {
@@ -218,6 +258,25 @@ unsigned char io_event(__attribute__((unused)) unsigned char channel) {
         break;
 
     case SEPROXYHAL_TAG_TICKER_EVENT:
+        global.ticks++;
+#       ifdef WALLET_APP
+            age_last_signature();
+#       endif
+        if (G.initial_screen_pending) {
+            ui_initial_screen();
+            break;
+        }
+#       ifdef BAKING_APP
+            if (is_idling()) {
+                if (G.baking_idle_screens.stale) {
+                    calculate_baking_idle_screens_data();
+                    UX_REDISPLAY();
+                } else if (baking_idle_screens_pkh_pending()) {
+                    calculate_baking_idle_screens_pkh();
+                    UX_REDISPLAY();
+                }
+            }
+#       endif
         if (ux.callback_interval_ms != 0) {
             ux.callback_interval_ms -= MIN(ux.callback_interval_ms, 100u);
             if (ux.callback_interval_ms == 0) {
@@ -267,7 +326,7 @@ static const bagl_element_t ui_multi_screen[] = {
       BAGL_GLYPH_ICON_CROSS},
      NULL },
 
-    {{BAGL_ICON, BAGL_STATIC_ELEMENT, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0,
+    {{BAGL_ICON, BAGL_CHECK_ELEMENT, 117, 13, 8, 6, 0, 0, 0, 0xFFFFFF, 0x000000, 0,
       BAGL_GLYPH_ICON_CHECK},
      NULL },
 
@@ -283,6 +342,7 @@ static const bagl_element_t ui_multi_screen[] = {
 void switch_screen(uint32_t which) {
     if (which >= MAX_SCREEN_COUNT) THROW(EXC_MEMORY_ERROR);
     const char *label = (const char*)PIC(global.ui.prompt.prompts[which]);
+    G.seen_screens |= 1u << which;
 
     strncpy(global.ui.prompt.active_prompt, label, sizeof(global.ui.prompt.active_prompt));
     if (global.ui.prompt.callbacks[which] == NULL) THROW(EXC_MEMORY_ERROR);
@@ -300,6 +360,8 @@ void clear_ui_callbacks(void) {
 __attribute__((noreturn))
 void ui_prompt(const char *const *labels, ui_callback_t ok_c, ui_callback_t cxl_c) {
     check_null(labels);
+    // The request behind a sign prompt is still waiting for its answer; nothing may take its place.
+    if (sign_prompt_pending()) THROW(EXC_SECURITY);
     global.ui.prompt.prompts = labels;
 
     size_t i;
@@ -331,16 +393,62 @@ void exit_app_cb(__attribute__((unused)) unsigned int cb) {
 
 // Mutually recursive static variables require forward declarations
 static const ux_menu_entry_t main_menu_data[];
+static const ux_menu_entry_t settings_menu_data[];
 static const ux_menu_entry_t about_menu_data[];
 
+static void settings_menu(unsigned int entry) {
+    UX_MENU_DISPLAY(entry, settings_menu_data, NULL);
+}
+
+static void set_screen_dwell(unsigned int dwell_ms) {
+    UPDATE_WALLET_SETTINGS(settings, settings->screen_dwell_ms = dwell_ms);
+    settings_menu(0);
+}
+
+static void set_fast_review(unsigned int enabled) {
+    UPDATE_WALLET_SETTINGS(settings, settings->fast_review = enabled);
+    settings_menu(1);
+}
+
+static const ux_menu_entry_t dwell_menu_data[] = {
+    {NULL, set_screen_dwell, 500, NULL, "0.5 seconds", NULL, 0, 0},
+    {NULL, set_screen_dwell, 1000, NULL, "1 second", NULL, 0, 0},
+    {NULL, set_screen_dwell, 2000, NULL, "2 seconds", NULL, 0, 0},
+    UX_MENU_END
+};
+
+static const ux_menu_entry_t fast_review_menu_data[] = {
+    {NULL, set_fast_review, false, NULL, "Off", NULL, 0, 0},
+    {NULL, set_fast_review, true, NULL, "On", NULL, 0, 0},
+    UX_MENU_END
+};
+
+// Both submenus open on the current value.
+static void dwell_menu(__attribute__((unused)) unsigned int cb) {
+    uint32_t const dwell_ms = prompt_dwell_ms();
+    UX_MENU_DISPLAY(dwell_ms <= 500 ? 0 : dwell_ms <= 1000 ? 1 : 2, dwell_menu_data, NULL);
+}
+
+static void fast_review_menu(__attribute__((unused)) unsigned int cb) {
+    UX_MENU_DISPLAY(N_wallet_settings.fast_review ? 1 : 0, fast_review_menu_data, NULL);
+}
+
+static const ux_menu_entry_t settings_menu_data[] = {
+    {NULL, dwell_menu, 0, NULL, "Screen time", NULL, 0, 0},
+    {NULL, fast_review_menu, 0, NULL, "Fast review", NULL, 0, 0},
+    {main_menu_data, NULL, 1, &C_icon_back, "Back", NULL, 61, 40},
+    UX_MENU_END
+};
+
 static const ux_menu_entry_t about_menu_data[] = {
     {NULL, NULL, 0, NULL, "Tezos Wallet", "Version " VERSION, 0, 0},
-    {main_menu_data, NULL, 1, &C_icon_back, "Back", NULL, 61, 40}, // TODO: Put icon for "back" in
+    {main_menu_data, NULL, 2, &C_icon_back, "Back", NULL, 61, 40}, // TODO: Put icon for "back" in
     UX_MENU_END
 };
 
 static const ux_menu_entry_t main_menu_data[] = {
     {NULL, NULL, 0, NULL, "Use wallet to", "view accounts", 0, 0},
+    {settings_menu_data, NULL, 0, NULL, "Settings", NULL, 0, 0},
     {about_menu_data, NULL, 0, NULL, "About", NULL, 0, 0},
     {NULL, exit_app_cb, 0, &C_icon_dashboard, "Quit app", NULL, 50, 29}, // TODO: Put icon for "dashboard" in
     UX_MENU_END
@@ -4,6 +4,7 @@
 
 #include "ui.h"
 
+#include "apdu_sign.h"
 #include "baking_auth.h"
 #include "exception.h"
 #include "globals.h"
@@ -54,8 +55,22 @@ unsigned char io_event(__attribute__((unused)) unsigned char channel) {
         break;
 
     case SEPROXYHAL_TAG_TICKER_EVENT:
+        global.ticks++;
+#       ifdef WALLET_APP
+            age_last_signature();
+#       endif
+        if (G.initial_screen_pending) {
+            ui_initial_screen();
+        }
 #       ifdef BAKING_APP
             // Disable ticker event handling to prevent screen saver from starting.
+            // Only bring the idle screens up to date.
+            else if (G.baking_idle_screens.stale) {
+                update_baking_idle_screens();
+            } else if (baking_idle_screens_pkh_pending()) {
+                calculate_baking_idle_screens_pkh();
+                ui_refresh();
+            }
 #       else
             UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {});
 #       endif
@@ -189,8 +204,11 @@ _Static_assert(NUM_ELEMENTS(ux_prompts_flow) - 3 /*reject + accept + end*/ == MA
 
 
 void ui_initial_screen(void) {
+    G.initial_screen_pending = false;
 #   ifdef BAKING_APP
-        calculate_baking_idle_screens_data();
+        if (G.baking_idle_screens.stale) {
+            calculate_baking_idle_screens_data();
+        }
 #   endif
 
     // reserve a display stack slot if none yet
@@ -203,6 +221,8 @@ void ui_initial_screen(void) {
 __attribute__((noreturn))
 void ui_prompt(const char *const *labels, ui_callback_t ok_c, ui_callback_t cxl_c) {
     check_null(labels);
+    // The request behind a sign prompt is still waiting for its answer; nothing may take its place.
+    if (sign_prompt_pending()) THROW(EXC_SECURITY);
 
     size_t const screen_count = ({
         size_t i = 0;
@@ -221,6 +241,7 @@ void ui_prompt(const char *const *labels, ui_callback_t ok_c, ui_callback_t cxl_
         G.prompt.callbacks[i](G.prompt.screen[offset + i].value, sizeof(G.prompt.screen[offset + i].value), G.prompt.callback_data[i]);
     }
 
+    G.initial_screen_pending = false;
     G.ok_callback = ok_c;
     G.cxl_callback = cxl_c;
     ux_flow_init(0, &ux_prompts_flow[offset], NULL);
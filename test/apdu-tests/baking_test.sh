@@ -84,3 +84,67 @@ fail() {
     echo 800481002a027a06a77000000000000000000000000000000000000000000000000000000000000000000000000001 # Endorse at level 1 (should fail)
   } | ./apdu.sh && fail ">>> EXPECTED FAILURE") || true
 }
+
+# apdu.sh drops the data of a reply that does not end in 9000, so the refusals are checked through
+# the emulator's APDU port (for example `speculos.py --display headless bin/app.elf`, port 9999).
+{
+  echo; echo "Re-baking a signed level should be refused with 6a80 and the high watermark"
+  echo "Baking with a key that is not authorized should be refused with 6982 and the high watermark"
+
+  APDU_PORT="${APDU_PORT:-9999}" python3 - <<'PYTHON'
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.getcwd(), "..", "bench"))
+from boot_to_first_signature import ApduSocket
+
+INS_SIGN = 0x04
+INS_QUERY_ALL_HWM = 0x0B
+
+P1_FIRST = 0x00
+P1_LAST_MARKER = 0x80
+CURVE_ED25519 = 0x00
+
+SW_OK = 0x9000
+SW_SECURITY = 0x6982
+SW_WRONG_VALUES = 0x6A80
+
+BAKING_PATH = bytes.fromhex("048000002c800006c18000000080000000")
+OTHER_PATH = bytes.fromhex("048000002c800006c18000000180000000")
+CHAIN_ID = 0x7A06A770
+
+
+def block(level):
+    return struct.pack(">BII", 0x01, CHAIN_ID, level) + b"\x02"
+
+
+def refusal(conn, path, level):
+    _, sw = conn.exchange(INS_SIGN, P1_FIRST, CURVE_ED25519, path)
+    if sw != SW_OK:
+        raise SystemExit("path: got %04x, expected 9000" % sw)
+    return conn.exchange(INS_SIGN, P1_LAST_MARKER | 0x01, CURVE_ED25519, block(level))
+
+
+conn = ApduSocket("127.0.0.1", int(os.environ["APDU_PORT"]), time.monotonic() + 10)
+conn.sock.settimeout(10)
+try:
+    data, sw = conn.exchange(INS_QUERY_ALL_HWM)
+    if sw != SW_OK:
+        raise SystemExit("high watermarks: got %04x, expected 9000" % sw)
+    main_chain_id = struct.unpack(">III", data)[2]
+    test_hwm = 0 if main_chain_id in (0, CHAIN_ID) else 1
+
+    # Level 2 was endorsed above: highest level 2, had an endorsement.
+    expected = struct.pack(">IBBI", 2, 1, test_hwm, main_chain_id)
+    for what, path, level, expected_sw in [("stale level", BAKING_PATH, 2, SW_WRONG_VALUES),
+                                           ("unauthorized key", OTHER_PATH, 3, SW_SECURITY)]:
+        data, sw = refusal(conn, path, level)
+        if sw != expected_sw or data != expected:
+            raise SystemExit("%s: got %s %04x, expected %s %04x" % (what, data.hex(), sw, expected.hex(), expected_sw))
+finally:
+    conn.close()
+PYTHON
+  echo "Pass"
+}
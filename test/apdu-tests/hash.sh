@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$DIR"
+
+{
+  echo; echo "Streamed hash of 200 bytes should be 2cd6e77231d3281ba5e7bc9c01a19d8600c9e80db5bb5ac446be6528abec039b"
+
+  {
+    echo 801000206403030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303
+    echo 801081206403030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303030303
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Batch of \"\" and \"abc\" should be 3345524abf6bbe1809449224b5972c41790b6cf2 384264f676f39536840523f284921cdc68b6846b"
+
+  {
+    echo 80100214050003616263
+  } | ./apdu.sh
+}
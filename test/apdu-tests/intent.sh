@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$DIR"
+
+{
+  echo; echo "Delegation intent should prompt for a delegation with fee 1 and answer with the forged bytes and signature (ACCEPT THIS)"
+
+  {
+    echo 8013000067048000002c800006c180000000800000005379ba9122785f71ec283a3b6398c05edc8f8d77eef885d167d22c50e9f9c26c6e00000000000f42400000000000000a1e00000000000c3500000000000000ea6000b5a3c247300abfea1242d10f347c321f796c1b88
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Transaction intent should prompt for 123.456789 tez to a KT1 and answer with the hash and signature (ACCEPT THIS)"
+
+  {
+    echo 8013010070048000002c800006c180000000800000005379ba9122785f71ec283a3b6398c05edc8f8d77eef885d167d22c50e9f9c26c6c000000000000058c0000000000000bb80000000000002968000000000000010100000000075bcd1501531ab5764a29f77c5d40b80a5da45c84468f08a100
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Intent with an unknown operation tag should be refused"
+
+  {
+    echo 8013000067048000002c800006c180000000800000005379ba9122785f71ec283a3b6398c05edc8f8d77eef885d167d22c50e9f9c26c6b00000000000f42400000000000000a1e00000000000c3500000000000000ea6000b5a3c247300abfea1242d10f347c321f796c1b88
+  } | ./apdu.sh || echo "Pass"
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Interleaves APDUs with a sign prompt on the Nano X wallet app.
+
+Connects to an emulator already running the wallet app (for example
+`speculos.py --model nanox --display headless bin/app.elf`). It streams a
+transaction in sign session 1 and leaves its prompt up. Meanwhile it:
+  - checks that session 1 refuses a new stream while its operation is shown;
+  - starts a stream in session 0 and asks for a public key, which both work;
+  - checks that completing the session 0 stream, and asking for a public key
+    to be shown, are refused instead of replacing the prompt.
+It then approves the prompt through the emulator's button API, and checks
+that the signed hash is the one of the transaction on screen.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import struct
+import sys
+import time
+import urllib.request
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "bench"))
+from boot_to_first_signature import ApduSocket  # noqa: E402
+
+INS_GET_PUBLIC_KEY = 0x02
+INS_PROMPT_PUBLIC_KEY = 0x03
+INS_SIGN_WITH_HASH = 0x0F
+
+P1_FIRST = 0x00
+P1_NEXT = 0x01
+P1_LAST_MARKER = 0x80
+P1_SESSION_1 = 0x10
+
+SW_OK = 0x9000
+SW_SECURITY = 0x6982
+
+PATH = bytes.fromhex("048000002c800006c18000000080000000")
+OTHER_PATH = bytes.fromhex("048000002c800006c18000000180000000")
+CURVE_ED25519 = 0x00
+
+# The valid transaction of test/apdu-tests/transaction.sh; six prompt screens.
+TRANSACTION = bytes.fromhex(
+    "0316d8aa98f84a30af5871642e9fab07597a14bf0a9a4f37bb8b734fd28007cee10700006fd9ff5e5aad9738883f9d291dd67f888221ad8f"
+    "ea0902904e000050a7e13e2ce14fd935a4258dbff7f4874421981177e083dd7a3a505d16b1e31d0800006fd9ff5e5aad9738883f9d291dd6"
+    "7f888221ad8fa20903bc5000c0c3930700006fd9ff5e5aad9738883f9d291dd67f888221ad8f00")
+PROMPT_SCREENS = 6
+
+
+def press(api, button):
+    request = urllib.request.Request(api + "/button/" + button, data=json.dumps({"action": "press-and-release"}).encode(),
+                                     headers={"Content-Type": "application/json"}, method="POST")
+    urllib.request.urlopen(request).read()
+
+
+def expect(what, sw, expected):
+    if sw != expected:
+        raise RuntimeError("%s: got %04x, expected %04x" % (what, sw, expected))
+    print("%s: %04x" % (what, sw))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9999, help="emulator APDU port (default: %(default)s)")
+    parser.add_argument("--api", default="http://127.0.0.1:5000", help="emulator REST API (default: %(default)s)")
+    parser.add_argument("--timeout", type=float, default=10, help="seconds allowed per APDU (default: %(default)s)")
+    args = parser.parse_args()
+
+    conn = ApduSocket(args.host, args.port, time.monotonic() + args.timeout)
+    conn.sock.settimeout(args.timeout)
+    try:
+        _, sw = conn.exchange(INS_SIGN_WITH_HASH, P1_SESSION_1 | P1_FIRST, CURVE_ED25519, PATH)
+        expect("session 1 path", sw, SW_OK)
+
+        # The reply to the last packet only comes once the prompt is answered.
+        apdu = bytes([0x80, INS_SIGN_WITH_HASH, P1_SESSION_1 | P1_LAST_MARKER, CURVE_ED25519, len(TRANSACTION)])
+        conn.sock.sendall(struct.pack(">I", len(apdu + TRANSACTION)) + apdu + TRANSACTION)
+        time.sleep(1)
+
+        _, sw = conn.exchange(INS_SIGN_WITH_HASH, P1_SESSION_1 | P1_FIRST, CURVE_ED25519, OTHER_PATH)
+        expect("new stream in session 1 during its prompt", sw, SW_SECURITY)
+        _, sw = conn.exchange(INS_SIGN_WITH_HASH, P1_FIRST, CURVE_ED25519, OTHER_PATH)
+        expect("session 0 path during the prompt", sw, SW_OK)
+        _, sw = conn.exchange(INS_GET_PUBLIC_KEY, 0, CURVE_ED25519, OTHER_PATH)
+        expect("public key during the prompt", sw, SW_OK)
+        _, sw = conn.exchange(INS_SIGN_WITH_HASH, P1_NEXT | P1_LAST_MARKER, CURVE_ED25519, TRANSACTION)
+        expect("session 0 prompt during the prompt", sw, SW_SECURITY)
+        _, sw = conn.exchange(INS_PROMPT_PUBLIC_KEY, 0, CURVE_ED25519, OTHER_PATH)
+        expect("public key prompt during the prompt", sw, SW_SECURITY)
+
+        # Page to the accept step, past every screen and the reject step, and take it.
+        for _ in range(PROMPT_SCREENS + 1):
+            press(args.api, "right")
+        press(args.api, "both")
+
+        size = struct.unpack(">I", conn._recv_exactly(4))[0]
+        response = conn._recv_exactly(size + 2)
+        expect("signature", struct.unpack(">H", response[-2:])[0], SW_OK)
+        signed_hash = response[:32]
+        if signed_hash != hashlib.blake2b(TRANSACTION, digest_size=32).digest():
+            raise RuntimeError("the signature is not over the transaction that was shown")
+    finally:
+        conn.close()
+
+    print("Pass")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$DIR"
+
+{
+  echo; echo "Signature should be resent for the same key and hash without a prompt (ACCEPT THIS ONCE)"
+
+  {
+    echo 800f000011048000002c800006c18000000080000000
+    echo 800f8100970316d8aa98f84a30af5871642e9fab07597a14bf0a9a4f37bb8b734fd28007cee10700006fd9ff5e5aad9738883f9d291dd67f888221ad8fea0902904e000050a7e13e2ce14fd935a4258dbff7f4874421981177e083dd7a3a505d16b1e31d0800006fd9ff5e5aad9738883f9d291dd67f888221ad8fa20903bc5000c0c3930700006fd9ff5e5aad9738883f9d291dd67f888221ad8f00
+    echo 800f040031048000002c800006c180000000800000008b1ed2186726f367c3653c372ed4daa5b7d1dd57a1753e3f7c83a911598df26e
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Resend for a different hash should be refused"
+
+  {
+    echo 800f040031048000002c800006c180000000800000000000000000000000000000000000000000000000000000000000000000000000
+  } | ./apdu.sh || echo "Pass"
+}
+
+{
+  echo; echo "Resend for a different key should be refused"
+
+  {
+    echo 800f040031048000002c800006c180000001800000008b1ed2186726f367c3653c372ed4daa5b7d1dd57a1753e3f7c83a911598df26e
+  } | ./apdu.sh || echo "Pass"
+}
+
+{
+  echo; echo "Resend after more than 10 seconds should be refused"
+  sleep 11
+
+  {
+    echo 800f040031048000002c800006c180000000800000008b1ed2186726f367c3653c372ed4daa5b7d1dd57a1753e3f7c83a911598df26e
+  } | ./apdu.sh || echo "Pass"
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$DIR"
+
+{
+  echo; echo "Scan of 4 accounts should answer 4 public key hashes in a single response"
+
+  {
+    echo 8012000013048000002c800006c180000000800000000004
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Scan of 5 accounts should answer 4 public key hashes and stop with 61xx to ask for more"
+
+  {
+    echo 8012000013048000002c800006c180000000800000000005
+  } | ./apdu.sh || echo "Pass"
+}
+
+{
+  echo; echo "Continue without a command in progress should be refused"
+
+  {
+    echo 8011010000
+  } | ./apdu.sh || echo "Pass"
+}
+
+{
+  echo; echo "Scan that would count into hardened accounts should be refused"
+
+  {
+    echo 801200000f038000002c800006c17ffffffe0003
+  } | ./apdu.sh || echo "Pass"
+}
+
+# The continuation token is only known once the device answers, so these talk to the emulator's
+# APDU port directly (for example `speculos.py --display headless bin/app.elf`, port 9999).
+{
+  echo; echo "Scan of 9 accounts through INS_CONTINUE should match the public keys derived one by one"
+  echo "Continue with a token ended by another instruction, or an old token, should be refused"
+
+  APDU_PORT="${APDU_PORT:-9999}" python3 - <<'PYTHON'
+import hashlib
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.getcwd(), "..", "bench"))
+from boot_to_first_signature import ApduSocket
+
+INS_VERSION = 0x00
+INS_GET_PUBLIC_KEY = 0x02
+INS_CONTINUE = 0x11
+INS_SCAN_PUBLIC_KEY_HASHES = 0x12
+
+SW_OK = 0x9000
+SW_WRONG_VALUES = 0x6A80
+SW_REFERENCED_DATA_NOT_FOUND = 0x6A88
+CURVE_ED25519 = 0x00
+
+COUNT = 9  # More than two responses' worth of hashes
+FIRST_ACCOUNT = 0x80000000
+
+
+def path(account):
+    return struct.pack(">BIII", 3, 0x8000002C, 0x800006C1, account)
+
+
+def expect(what, sw, expected):
+    if sw != expected:
+        raise SystemExit("%s: got %04x, expected %04x" % (what, sw, expected))
+
+
+def start_scan(conn):
+    data, sw = conn.exchange(INS_SCAN_PUBLIC_KEY_HASHES, 0, CURVE_ED25519,
+                             path(FIRST_ACCOUNT) + struct.pack(">H", COUNT))
+    if sw & 0xFF00 != 0x6100:
+        raise SystemExit("scan: got %04x, expected 61xx" % sw)
+    return data, sw & 0xFF
+
+
+conn = ApduSocket("127.0.0.1", int(os.environ["APDU_PORT"]), time.monotonic() + 10)
+conn.sock.settimeout(30)
+try:
+    scanned, token = start_scan(conn)
+    responses = 1
+    while True:
+        data, sw = conn.exchange(INS_CONTINUE, token)
+        scanned += data
+        responses += 1
+        if sw == SW_OK:
+            break
+        if sw & 0xFF00 != 0x6100:
+            raise SystemExit("continue: got %04x, expected 61xx or 9000" % sw)
+        token = sw & 0xFF
+    if responses != 3:
+        raise SystemExit("scan took %d responses, expected 3" % responses)
+
+    expected = b""
+    for account in range(FIRST_ACCOUNT, FIRST_ACCOUNT + COUNT):
+        data, sw = conn.exchange(INS_GET_PUBLIC_KEY, 0, CURVE_ED25519, path(account))
+        expect("public key", sw, SW_OK)
+        public_key = data[1:1 + data[0]]
+        expected += hashlib.blake2b(public_key[1:], digest_size=20).digest()  # Without the 0x02 prefix
+    if scanned != expected:
+        raise SystemExit("scanned hashes differ from the derived public keys")
+
+    _, stale = start_scan(conn)
+    _, sw = conn.exchange(INS_VERSION)
+    expect("version", sw, SW_OK)
+    _, sw = conn.exchange(INS_CONTINUE, stale)
+    expect("continue after another instruction", sw, SW_REFERENCED_DATA_NOT_FOUND)
+
+    _, token = start_scan(conn)
+    _, sw = conn.exchange(INS_CONTINUE, stale)
+    expect("continue with the previous scan's token", sw, SW_WRONG_VALUES)
+    # Like any error, the refusal ends the command in progress.
+    _, sw = conn.exchange(INS_CONTINUE, token)
+    expect("continue after a refused token", sw, SW_REFERENCED_DATA_NOT_FOUND)
+finally:
+    conn.close()
+PYTHON
+  echo "Pass"
+}
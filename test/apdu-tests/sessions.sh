@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$DIR"
+
+{
+  echo; echo "Nano X: delegation streamed in session 1 should survive a public key query and a new stream in session 0 (ACCEPT THIS)"
+
+  {
+    echo 8004100011048000002c800006c18000000080000000
+    echo 8002000011048000002c800006c18000000080000000
+    echo 8004000011048000002c800006c18000000180000000
+    echo 800491009003a5d415ec9358f2323e45fdbdf0cbcfe7e632d13d1bb5398eb9a62488675e72620700007389eed7ec0bcd5642ee21a21be3b760a39d2ed100020000005a244f9bc69af75f6a88f061653efe49a462f4a8fea00117d97ab060ea0ea4700a00007389eed7ec0bcd5642ee21a21be3b760a39d2ed1d08603030000ff007389eed7ec0bcd5642ee21a21be3b760a39d2ed1
+  } | ./apdu.sh
+}
+
+{
+  echo; echo "Session 2 does not exist and should be refused"
+
+  {
+    echo 8004200011048000002c800006c18000000080000000
+  } | ./apdu.sh || echo "Pass"
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Measures how long the app takes from a reset to its first answered APDU and
+its first baking signature.
+
+Each run starts the emulator with --emulator-cmd (for example
+`speculos.py --model nanos --display headless bin/app.elf`), connects to its
+APDU port as soon as it accepts connections and sends INS_VERSION until the
+app answers. If the app has an authorized baking key, it then signs a block
+just above the high watermark. All times are measured from the moment the
+emulator process was started.
+
+Emulators that start from an empty NVRAM have no authorized key. For those,
+only the time to the first APDU is reported.
+"""
+
+import argparse
+import os
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+CLA = 0x80
+INS_VERSION = 0x00
+INS_SIGN = 0x04
+INS_QUERY_ALL_HWM = 0x0B
+INS_QUERY_AUTH_KEY_WITH_CURVE = 0x0D
+
+P1_FIRST = 0x00
+P1_LAST_MARKER = 0x80
+
+MAGIC_BYTE_BLOCK = 0x01
+
+
+class ApduSocket:
+    """Speaks the emulator's APDU framing: 4-byte length, payload, and a trailing status word on replies."""
+
+    def __init__(self, host, port, deadline):
+        while True:
+            try:
+                self.sock = socket.create_connection((host, port), timeout=1)
+                return
+            except OSError:
+                if time.monotonic() > deadline:
+                    raise
+                time.sleep(0.005)
+
+    def _recv_exactly(self, size):
+        data = b""
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("emulator closed the APDU connection")
+            data += chunk
+        return data
+
+    def exchange(self, ins, p1=0, p2=0, data=b""):
+        apdu = bytes([CLA, ins, p1, p2, len(data)]) + data
+        self.sock.sendall(struct.pack(">I", len(apdu)) + apdu)
+        size = struct.unpack(">I", self._recv_exactly(4))[0]
+        response = self._recv_exactly(size + 2)
+        return response[:-2], struct.unpack(">H", response[-2:])[0]
+
+    def close(self):
+        self.sock.close()
+
+
+def block(chain_id, level):
+    return struct.pack(">BIIB", MAGIC_BYTE_BLOCK, chain_id, level, 1) + bytes(32) + struct.pack(">QB", 0, 4) + bytes(32)
+
+
+def run_once(args):
+    start = time.monotonic()
+    deadline = start + args.timeout
+    emulator = subprocess.Popen(args.emulator_cmd, shell=True, start_new_session=True,
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        while True:
+            conn = ApduSocket(args.host, args.port, deadline)
+            try:
+                _, sw = conn.exchange(INS_VERSION)
+                if sw == 0x9000:
+                    break
+            except (ConnectionError, socket.timeout):
+                pass
+            conn.close()
+            if time.monotonic() > deadline:
+                raise TimeoutError("no answer to INS_VERSION")
+        first_apdu = time.monotonic() - start
+
+        try:
+            key, sw = conn.exchange(INS_QUERY_AUTH_KEY_WITH_CURVE)
+            if sw != 0x9000 or len(key) < 2 or key[1] == 0:
+                return first_apdu, None
+            curve, length = key[0], key[1]
+            path = bytes([length]) + key[2:2 + 4 * length]
+
+            hwm, sw = conn.exchange(INS_QUERY_ALL_HWM)
+            main_hwm, _, chain_id = struct.unpack(">III", hwm[:12])
+            conn.exchange(INS_SIGN, P1_FIRST, curve, path)
+            _, sw = conn.exchange(INS_SIGN, P1_LAST_MARKER, curve, block(chain_id, main_hwm + 1))
+            if sw != 0x9000:
+                raise RuntimeError("block signature failed with %04x" % sw)
+            return first_apdu, time.monotonic() - start
+        finally:
+            conn.close()
+    finally:
+        os.killpg(emulator.pid, signal.SIGTERM)
+        emulator.wait()
+
+
+def summarize(name, values):
+    if not values:
+        return
+    ordered = sorted(values)
+    print("%-16s min %7.1f  p50 %7.1f  max %7.1f ms" % (
+        name, ordered[0] * 1000, ordered[len(ordered) // 2] * 1000, ordered[-1] * 1000))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--emulator-cmd", required=True, help="shell command starting the emulator with the app")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9999, help="emulator APDU port (default: %(default)s)")
+    parser.add_argument("--runs", type=int, default=10, help="number of resets to measure (default: %(default)s)")
+    parser.add_argument("--timeout", type=float, default=30, help="seconds allowed per run (default: %(default)s)")
+    args = parser.parse_args()
+
+    first_apdus = []
+    first_signatures = []
+    for run in range(args.runs):
+        first_apdu, first_signature = run_once(args)
+        first_apdus.append(first_apdu)
+        if first_signature is not None:
+            first_signatures.append(first_signature)
+        print("run %d: first APDU %.1f ms, first signature %s" % (
+            run, first_apdu * 1000,
+            "%.1f ms" % (first_signature * 1000) if first_signature is not None else "n/a (no authorized key)"))
+
+    summarize("first APDU", first_apdus)
+    summarize("first signature", first_signatures)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
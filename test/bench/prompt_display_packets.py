@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Counts the display packets the wallet app sends while a prompt is shown.
+
+Connects to an emulator already running the wallet app (for example
+`speculos.py --model nanos --display headless bin/app.elf`), signs a
+transaction with the timing trailer requested, and approves the prompt through
+the emulator's button API after --review-seconds. The trailer reports the
+ticks the prompt was up and the screen elements sent meanwhile.
+
+Run it against builds before and after a display change to compare them; the
+packets per tick are what the display costs while APDUs are waiting.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+import urllib.request
+
+from boot_to_first_signature import ApduSocket
+
+INS_SIGN_WITH_HASH = 0x0F
+
+P1_FIRST = 0x00
+P1_TIMING_TRAILER = 0x40
+P1_LAST_MARKER = 0x80
+
+TRAILER_SIZE = 9  # Ticker period, prompt ticks, display packets
+
+PATH = bytes.fromhex("048000002c800006c18000000080000000")
+CURVE_ED25519 = 0x00
+
+# The valid transaction of test/apdu-tests/transaction.sh; six prompt screens.
+TRANSACTION = bytes.fromhex(
+    "0316d8aa98f84a30af5871642e9fab07597a14bf0a9a4f37bb8b734fd28007cee10700006fd9ff5e5aad9738883f9d291dd67f888221ad8f"
+    "ea0902904e000050a7e13e2ce14fd935a4258dbff7f4874421981177e083dd7a3a505d16b1e31d0800006fd9ff5e5aad9738883f9d291dd6"
+    "7f888221ad8fa20903bc5000c0c3930700006fd9ff5e5aad9738883f9d291dd67f888221ad8f00")
+
+
+def parse_trailer(trailer):
+    tick_ms = trailer[0]
+    ticks, packets = struct.unpack(">II", trailer[1:9])
+    return tick_ms, ticks, packets
+
+
+def press_right(api):
+    request = urllib.request.Request(api + "/button/right", data=json.dumps({"action": "press-and-release"}).encode(),
+                                     headers={"Content-Type": "application/json"}, method="POST")
+    urllib.request.urlopen(request).read()
+
+
+def run_once(args):
+    conn = ApduSocket(args.host, args.port, time.monotonic() + args.timeout)
+    try:
+        _, sw = conn.exchange(INS_SIGN_WITH_HASH, P1_FIRST, CURVE_ED25519, PATH)
+        if sw != 0x9000:
+            raise RuntimeError("path packet failed with %04x" % sw)
+
+        # The reply only comes once the prompt is approved.
+        conn.sock.settimeout(args.review_seconds + args.timeout)
+        apdu = bytes([0x80, INS_SIGN_WITH_HASH, P1_LAST_MARKER | P1_TIMING_TRAILER, CURVE_ED25519, len(TRANSACTION)])
+        conn.sock.sendall(struct.pack(">I", len(apdu + TRANSACTION)) + apdu + TRANSACTION)
+        time.sleep(args.review_seconds)
+        press_right(args.api)
+
+        size = struct.unpack(">I", conn._recv_exactly(4))[0]
+        response = conn._recv_exactly(size + 2)
+        sw = struct.unpack(">H", response[-2:])[0]
+        if sw != 0x9000:
+            raise RuntimeError("signature failed with %04x" % sw)
+        return parse_trailer(response[:-2][-TRAILER_SIZE:])
+    finally:
+        conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9999, help="emulator APDU port (default: %(default)s)")
+    parser.add_argument("--api", default="http://127.0.0.1:5000", help="emulator REST API (default: %(default)s)")
+    parser.add_argument("--review-seconds", type=float, default=12,
+                        help="time to leave the prompt up before approving (default: %(default)s)")
+    parser.add_argument("--runs", type=int, default=5, help="number of prompts to measure (default: %(default)s)")
+    parser.add_argument("--timeout", type=float, default=10, help="seconds allowed per APDU (default: %(default)s)")
+    args = parser.parse_args()
+
+    rates = []
+    for run in range(args.runs):
+        tick_ms, ticks, packets = run_once(args)
+        rate = packets / ticks if ticks else float(packets)
+        rates.append(rate)
+        print("run %d: prompt up %d ms, %d display packets, %.2f packets per tick" % (
+            run, ticks * tick_ms, packets, rate))
+
+    rates.sort()
+    print("packets per tick: min %.2f  p50 %.2f  max %.2f" % (rates[0], rates[len(rates) // 2], rates[-1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Records the APDU traffic of a live host, anonymized, for replay_load.py.
+
+Runs as a TCP proxy between a host and an app reached through the APDU socket
+protocol (an emulator, or a device behind a ledgerblue TCP proxy). Point the
+host at the proxy, for example with LEDGER_PROXY_ADDRESS=127.0.0.1 and
+LEDGER_PROXY_PORT=<--listen-port>, and let it run through a representative
+stretch of production work: level boundaries, HWM polls, payouts, HMACs.
+
+One JSON line is written per request. Multi-packet signatures count as a
+single request from their path packet to the final reply, tracked per sign
+session; long commands count as one request from their first packet to the
+last INS_CONTINUE reply. Nothing identifying is kept: no key paths, no
+payload or response bytes, only the instruction, the sign session, the kind
+of data signed (from its magic byte or intent tag), sizes, the status word,
+and timings relative to the start of the recording.
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+INS_SIGN = 0x04
+INS_SIGN_UNSAFE = 0x05
+INS_HMAC = 0x0E
+INS_SIGN_WITH_HASH = 0x0F
+INS_CONTINUE = 0x11
+INS_SIGN_INTENT = 0x13
+SIGN_INSTRUCTIONS = (INS_SIGN, INS_SIGN_UNSAFE, INS_SIGN_WITH_HASH)
+
+P1_FIRST = 0x00
+P1_SESSION_MASK = 0x30
+P1_SESSION_SHIFT = 4
+P1_TIMING_TRAILER = 0x40
+P1_LAST_MARKER = 0x80
+
+SW_OK = 0x9000
+SW_MORE = 0x6100  # The low byte is the continuation token
+
+MAGIC_BYTES = {0x01: "block", 0x02: "endorsement", 0x03: "operation", 0x05: "michelson"}
+INTENT_TAGS = {0x6C: "transaction", 0x6E: "delegation"}
+INTENT_BRANCH_SIZE = 32
+
+
+def recv_exactly(sock, size):
+    data = b""
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("connection closed")
+        data += chunk
+    return data
+
+
+def path_size(cdata):
+    return 1 + 4 * cdata[0] if cdata else 0
+
+
+class Recorder:
+    def __init__(self, out):
+        self.out = out
+        self.start = time.monotonic()
+        self.pending = {}  # Sign requests waiting for their last packet, by session
+        self.long_command = None  # Request answered with SW_MORE, waiting for its INS_CONTINUE packets
+
+    def write(self, record):
+        self.out.write(json.dumps(record) + "\n")
+        self.out.flush()
+
+    def finish(self, record, replied, sw):
+        record.update(sw="%04x" % sw, latency_ms=(replied - self.start - record["t"]) * 1000)
+        self.write(record)
+
+    def exchange(self, apdu, sent, replied, sw):
+        ins, p1, p2, cdata = apdu[1], apdu[2], apdu[3], apdu[5:]
+        latency_ms = (replied - sent) * 1000
+
+        if ins == INS_CONTINUE:
+            if self.long_command is None:
+                return  # Recording started in the middle of a long command
+            self.long_command["packets"] += 1
+            self.long_command["service_ms"] += latency_ms
+            if sw & 0xFF00 != SW_MORE:
+                self.finish(self.long_command, replied, sw)
+                self.long_command = None
+            return
+        if self.long_command is not None:
+            # Any other instruction abandons the long command; it keeps its last SW_MORE status word.
+            self.write(self.long_command)
+            self.long_command = None
+
+        if ins in SIGN_INSTRUCTIONS:
+            session = (p1 & P1_SESSION_MASK) >> P1_SESSION_SHIFT
+            step = p1 & ~(P1_SESSION_MASK | P1_TIMING_TRAILER | P1_LAST_MARKER)
+            if step == P1_FIRST:
+                self.pending[session] = {"t": sent - self.start, "ins": ins, "session": session, "curve": p2,
+                                         "kind": None, "packets": 0, "bytes": 0, "service_ms": 0.0}
+            pending = self.pending.get(session)
+            if pending is None or pending["ins"] != ins:
+                return  # Recording started in the middle of a signature
+            if step != P1_FIRST:
+                if pending["kind"] is None and cdata:
+                    pending["kind"] = MAGIC_BYTES.get(cdata[0], "other")
+                pending["bytes"] += len(cdata)
+            pending["packets"] += 1
+            pending["service_ms"] += latency_ms
+            if p1 & P1_LAST_MARKER or sw != SW_OK:
+                self.finish(self.pending.pop(session), replied, sw)
+            return
+
+        record = {"t": sent - self.start, "ins": ins, "p1": p1, "curve": p2, "packets": 1, "bytes": len(cdata),
+                  "sw": "%04x" % sw, "latency_ms": latency_ms, "service_ms": latency_ms}
+        if ins == INS_HMAC:
+            record["bytes"] = len(cdata) - path_size(cdata)
+        elif ins == INS_SIGN_INTENT:
+            # A whole signature in one packet: the path, then the intent starting with its branch.
+            intent = cdata[path_size(cdata):]
+            tag = intent[INTENT_BRANCH_SIZE] if len(intent) > INTENT_BRANCH_SIZE else None
+            record.update(p1=p1 & ~P1_SESSION_MASK, session=(p1 & P1_SESSION_MASK) >> P1_SESSION_SHIFT,
+                          kind=INTENT_TAGS.get(tag, "other"), bytes=len(intent))
+        if sw & 0xFF00 == SW_MORE:
+            self.long_command = record
+        else:
+            self.write(record)
+
+
+def proxy(client, target, recorder):
+    while True:
+        try:
+            request = recv_exactly(client, struct.unpack(">I", recv_exactly(client, 4))[0])
+        except ConnectionError:
+            return
+        sent = time.monotonic()
+        target.sendall(struct.pack(">I", len(request)) + request)
+        size_bytes = recv_exactly(target, 4)
+        response = recv_exactly(target, struct.unpack(">I", size_bytes)[0] + 2)
+        replied = time.monotonic()
+        client.sendall(size_bytes + response)
+        if len(request) >= 5:
+            recorder.exchange(request, sent, replied, struct.unpack(">H", response[-2:])[0])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--listen-port", type=int, default=9998, help="port the host connects to (default: %(default)s)")
+    parser.add_argument("--target-host", default="127.0.0.1")
+    parser.add_argument("--target-port", type=int, default=9999, help="APDU port of the app (default: %(default)s)")
+    parser.add_argument("--out", required=True, help="JSON lines file to write the recording to")
+    args = parser.parse_args()
+
+    server = socket.create_server(("127.0.0.1", args.listen_port))
+    with open(args.out, "w") as out:
+        recorder = Recorder(out)
+        print("recording to %s; connect the host to 127.0.0.1:%d" % (args.out, args.listen_port))
+        while True:
+            client, _ = server.accept()
+            with client, socket.create_connection((args.target_host, args.target_port)) as target:
+                proxy(client, target, recorder)
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(0)
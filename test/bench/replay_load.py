@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Replays a traffic recording from record_apdus.py against an emulated app.
+
+Connects to an emulator already running the baking app with an authorized
+key (see boot_to_first_signature.py for the APDU socket). Requests are sent
+open-loop on the recording's schedule, compressed by --speed (1 to 100). The
+app answers one APDU at a time, so a request whose slot comes up while an
+earlier one is still running waits; that wait is its queueing delay.
+
+Payloads are synthesized, since the recording keeps none:
+  - blocks and endorsements are signed with the authorized key at fresh
+    levels above the high watermark, so none is refused, in the sign
+    session they were recorded in;
+  - HMACs and hashes get random data of the recorded size;
+  - queries are sent as recorded.
+Requests that would prompt (wallet operations and intents, key prompts,
+setup) cannot be replayed unattended and are counted as skipped. Replies
+ending in 0x61XX are followed with INS_CONTINUE until the command is done.
+
+Per instruction, it reports the service time (first APDU sent to last reply)
+and the queueing delay, as percentiles.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+from boot_to_first_signature import ApduSocket
+
+INS_NAMES = {
+    0x00: "INS_VERSION",
+    0x02: "INS_GET_PUBLIC_KEY",
+    0x04: "INS_SIGN",
+    0x07: "INS_QUERY_AUTH_KEY",
+    0x08: "INS_QUERY_MAIN_HWM",
+    0x09: "INS_GIT",
+    0x0B: "INS_QUERY_ALL_HWM",
+    0x0D: "INS_QUERY_AUTH_KEY_WITH_CURVE",
+    0x0E: "INS_HMAC",
+    0x0F: "INS_SIGN_WITH_HASH",
+    0x10: "INS_HASH",
+    0x11: "INS_CONTINUE",
+    0x12: "INS_SCAN_PUBLIC_KEY_HASHES",
+    0x13: "INS_SIGN_INTENT",
+}
+INS_GET_PUBLIC_KEY = 0x02
+INS_SIGN = 0x04
+INS_QUERY_ALL_HWM = 0x0B
+INS_QUERY_AUTH_KEY_WITH_CURVE = 0x0D
+INS_HMAC = 0x0E
+INS_SIGN_WITH_HASH = 0x0F
+INS_HASH = 0x10
+INS_CONTINUE = 0x11
+INS_SIGN_INTENT = 0x13
+QUERIES = (0x00, 0x07, 0x08, 0x09, 0x0B, 0x0D)
+
+P1_FIRST = 0x00
+P1_SESSION_SHIFT = 4
+P1_LAST_MARKER = 0x80
+
+SW_OK = 0x9000
+SW_MORE = 0x6100  # The low byte is the continuation token
+
+MAGIC_BYTE_BLOCK = 0x01
+MAGIC_BYTE_BAKING_OP = 0x02
+
+MAINNET_CHAIN_ID = 0x7A06A770  # NetXdQprcVkpaWU
+
+MAX_APDU_SIZE = 230
+
+
+class Replayer:
+    def __init__(self, conn):
+        self.conn = conn
+        key, sw = conn.exchange(INS_QUERY_AUTH_KEY_WITH_CURVE)
+        if sw != 0x9000 or len(key) < 2 or key[1] == 0:
+            raise RuntimeError("the app has no authorized baking key")
+        self.curve = key[0]
+        self.path = bytes([key[1]]) + key[2:2 + 4 * key[1]]
+        hwm, _ = conn.exchange(INS_QUERY_ALL_HWM)
+        self.level, _, chain_id = struct.unpack(">III", hwm[:12])
+        self.chain_id = chain_id or MAINNET_CHAIN_ID
+
+    def block(self):
+        self.level += 1
+        return (struct.pack(">BIIB", MAGIC_BYTE_BLOCK, self.chain_id, self.level, 1) + os.urandom(32)
+                + struct.pack(">QB", 0, 4) + os.urandom(32))
+
+    def endorsement(self):
+        self.level += 1
+        return struct.pack(">BI", MAGIC_BYTE_BAKING_OP, self.chain_id) + os.urandom(32) + struct.pack(">BI", 0, self.level)
+
+    def apdus(self, record):
+        """Returns the APDUs (ins, p1, p2, data) standing in for a recorded request, or None to skip it."""
+        ins = record["ins"]
+        if ins in (INS_SIGN, INS_SIGN_WITH_HASH):
+            kinds = {"block": self.block, "endorsement": self.endorsement}
+            if record.get("kind") not in kinds:
+                return None
+            payload = kinds[record["kind"]]()
+            session = record.get("session", 0) << P1_SESSION_SHIFT
+            return [(ins, session | P1_FIRST, self.curve, self.path),
+                    (ins, session | P1_LAST_MARKER, self.curve, payload)]
+        if ins == INS_SIGN_INTENT:
+            return None  # Always prompts
+        if ins == INS_HMAC:
+            size = min(record["bytes"], MAX_APDU_SIZE - len(self.path))
+            return [(ins, 0, self.curve, self.path + os.urandom(size))]
+        if ins == INS_HASH:
+            return [(ins, P1_LAST_MARKER, 0, os.urandom(min(record["bytes"], MAX_APDU_SIZE)))]
+        if ins == INS_GET_PUBLIC_KEY:
+            return [(ins, 0, self.curve, self.path)]
+        if ins in QUERIES:
+            return [(ins, record.get("p1", 0), record.get("curve", 0), b"")]
+        return None
+
+    def run(self, apdus):
+        sw = SW_OK
+        for ins, p1, p2, data in apdus:
+            _, sw = self.conn.exchange(ins, p1, p2, data)
+            while sw & 0xFF00 == SW_MORE:
+                _, sw = self.conn.exchange(INS_CONTINUE, sw & 0xFF)
+            if sw != SW_OK:
+                break
+        return sw
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[(len(ordered) - 1) * pct // 100]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("recording", help="JSON lines file written by record_apdus.py")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9999, help="emulator APDU port (default: %(default)s)")
+    parser.add_argument("--speed", type=float, default=1, help="replay speed, 1 to 100 (default: %(default)s)")
+    parser.add_argument("--timeout", type=float, default=10, help="seconds allowed per APDU (default: %(default)s)")
+    parser.add_argument("--summary", help="write the per-instruction results as JSON to this file")
+    args = parser.parse_args()
+    if not 1 <= args.speed <= 100:
+        parser.error("--speed must be between 1 and 100")
+
+    with open(args.recording) as f:
+        records = sorted((json.loads(line) for line in f if line.strip()), key=lambda record: record["t"])
+
+    conn = ApduSocket(args.host, args.port, time.monotonic() + args.timeout)
+    conn.sock.settimeout(args.timeout)
+    replayer = Replayer(conn)
+
+    results = {}
+    skipped = 0
+    start = time.monotonic()
+    try:
+        for record in records:
+            apdus = replayer.apdus(record)
+            if apdus is None:
+                skipped += 1
+                continue
+            scheduled = start + record["t"] / args.speed
+            now = time.monotonic()
+            if now < scheduled:
+                time.sleep(scheduled - now)
+            sent = time.monotonic()
+            sw = replayer.run(apdus)
+            done = time.monotonic()
+
+            name = INS_NAMES.get(record["ins"], "0x%02x" % record["ins"])
+            result = results.setdefault(name, {"service": [], "queueing": [], "errors": 0})
+            result["service"].append((done - sent) * 1000)
+            result["queueing"].append(max(0.0, sent - scheduled) * 1000)
+            result["errors"] += sw != SW_OK
+    finally:
+        conn.close()
+
+    summary = {"speed": args.speed, "skipped": skipped, "instructions": {}}
+    print("%-30s %6s %6s  %28s  %28s" % ("instruction", "count", "errors",
+                                        "service ms p50/p90/p99", "queueing ms p50/p90/p99"))
+    for name, result in sorted(results.items()):
+        service = [percentile(result["service"], pct) for pct in (50, 90, 99)]
+        queueing = [percentile(result["queueing"], pct) for pct in (50, 90, 99)]
+        summary["instructions"][name] = {"count": len(result["service"]), "errors": result["errors"],
+                                         "service_ms": dict(zip(("p50", "p90", "p99"), service)),
+                                         "queueing_ms": dict(zip(("p50", "p90", "p99"), queueing))}
+        print("%-30s %6d %6d  %8.1f %8.1f %8.1f  %8.1f %8.1f %8.1f" % (
+            name, len(result["service"]), result["errors"], *service, *queueing))
+    print("%d requests skipped (prompts or unsupported instructions)" % skipped)
+
+    if args.summary:
+        with open(args.summary, "w") as f:
+            json.dump(summary, f, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,425 @@
+// Re-splits every operation in the corpus at many chunk boundaries and checks
+// that the resumable wallet parser gives the same answer for all of them.
+//
+// The reference parse is the whole operation in as few APDU-sized chunks as
+// possible. It is compared against:
+//   - every two-way split,
+//   - every fixed chunk size from 1 to MAX_APDU_SIZE,
+//   - RANDOM_CHUNKINGS random splits into 1..MAX_APDU_SIZE byte chunks.
+// The cost of every parse_operations_packet call is recorded and summarized
+// per corpus entry.
+//
+// Transfer intents are forged and compared byte for byte with the operation
+// they describe, which then goes through the same checks as the corpus.
+
+#include "forge.h"
+#include "globals.h"
+#include "operations.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_OPERATION_SIZE 1024
+#define RANDOM_CHUNKINGS 500
+#define MAX_CHUNKS MAX_OPERATION_SIZE
+
+#define G SIGN_SESSION
+
+// ------------------------------------------------------------ SDK stand-ins
+
+globals_t global;
+unsigned char G_io_apdu_buffer[260];
+unsigned int G_io_apdu_media;
+
+static try_context_t *current_try_context;
+
+try_context_t *try_context_get(void) {
+    return current_try_context;
+}
+
+try_context_t *try_context_set(try_context_t *context) {
+    try_context_t *const previous = current_try_context;
+    current_try_context = context;
+    return previous;
+}
+
+void os_longjmp(unsigned int exception) {
+    if (current_try_context == NULL) {
+        fprintf(stderr, "Uncaught exception 0x%04x\n", exception);
+        abort();
+    }
+    longjmp(current_try_context->jmp_buf, exception);
+}
+
+unsigned short io_exchange(
+    __attribute__((unused)) unsigned char channel_and_flags,
+    __attribute__((unused)) unsigned short tx_len
+) {
+    abort();
+}
+
+// ------------------------------------------------------------ key stand-ins
+
+// The corpus names the key each operation is signed with, so "deriving" it
+// just hands back what the current entry asked for.
+static struct {
+    uint8_t pkh[HASH_SIZE];
+    cx_ecfp_public_key_t compressed;
+} signing_key;
+
+void generate_compressed_public_key(
+    cx_ecfp_public_key_t *const out,
+    __attribute__((unused)) derivation_type_t const derivation_type,
+    __attribute__((unused)) bip32_path_t const *const bip32_path
+) {
+    memcpy(out, &signing_key.compressed, sizeof(*out));
+}
+
+void compressed_public_key_hash(
+    uint8_t *const out, size_t const out_size,
+    __attribute__((unused)) cx_ecfp_public_key_t const *const compressed
+) {
+    if (out_size < HASH_SIZE) THROW(EXC_WRONG_LENGTH);
+    memcpy(out, signing_key.pkh, HASH_SIZE);
+}
+
+// ------------------------------------------------------------ corpus
+
+struct corpus_entry {
+    char name[64];
+    bool expect_valid;
+    uint8_t pkh[HASH_SIZE];
+    uint8_t public_key[32];
+    uint8_t op[MAX_OPERATION_SIZE];
+    size_t op_size;
+};
+
+static size_t parse_hex(uint8_t *const out, size_t const out_size, char const *const hex) {
+    size_t const len = strlen(hex);
+    if (len % 2 != 0 || len / 2 > out_size) {
+        fprintf(stderr, "Bad hex string: %s\n", hex);
+        exit(2);
+    }
+    for (size_t i = 0; i < len / 2; i++) {
+        unsigned int byte;
+        if (sscanf(&hex[i * 2], "%2x", &byte) != 1) {
+            fprintf(stderr, "Bad hex string: %s\n", hex);
+            exit(2);
+        }
+        out[i] = byte;
+    }
+    return len / 2;
+}
+
+// Format, one entry per line: <name> <valid|invalid> <signing pkh> <public key> <operation>
+static bool read_entry(FILE *const in, struct corpus_entry *const out) {
+    char line[4 * MAX_OPERATION_SIZE];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        static char expect[16], pkh[2 * HASH_SIZE + 1], public_key[2 * 32 + 1], op[2 * MAX_OPERATION_SIZE + 1];
+        if (sscanf(line, "%63s %15s %40s %64s %2048s", out->name, expect, pkh, public_key, op) != 5) {
+            fprintf(stderr, "Bad corpus line: %s", line);
+            exit(2);
+        }
+        out->expect_valid = strcmp(expect, "valid") == 0;
+        parse_hex(out->pkh, sizeof(out->pkh), pkh);
+        parse_hex(out->public_key, sizeof(out->public_key), public_key);
+        out->op_size = parse_hex(out->op, sizeof(out->op), op);
+        return true;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------ parsing
+
+// Same as the wallet app.
+static bool is_operation_allowed(enum operation_tag tag) {
+    switch (tag) {
+        case OPERATION_TAG_ATHENS_DELEGATION: return true;
+        case OPERATION_TAG_ATHENS_REVEAL: return true;
+        case OPERATION_TAG_BABYLON_DELEGATION: return true;
+        case OPERATION_TAG_BABYLON_REVEAL: return true;
+        case OPERATION_TAG_PROPOSAL: return true;
+        case OPERATION_TAG_BALLOT: return true;
+        case OPERATION_TAG_ATHENS_ORIGINATION: return true;
+        case OPERATION_TAG_ATHENS_TRANSACTION: return true;
+        case OPERATION_TAG_BABYLON_ORIGINATION: return true;
+        case OPERATION_TAG_BABYLON_TRANSACTION: return true;
+        default: return false;
+    }
+}
+
+struct parse_result {
+    bool valid;
+    struct parsed_operation_group ops;
+};
+
+struct chunking {
+    size_t sizes[MAX_CHUNKS];
+    size_t count;
+};
+
+struct cost_samples {
+    uint64_t *ns;
+    size_t count;
+    size_t capacity;
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void record_cost(struct cost_samples *const samples, uint64_t const ns) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity == 0 ? 1024 : samples->capacity * 2;
+        samples->ns = realloc(samples->ns, samples->capacity * sizeof(*samples->ns));
+        if (samples->ns == NULL) abort();
+    }
+    samples->ns[samples->count++] = ns;
+}
+
+// Mirrors what handle_apdu does with each packet of an INS_SIGN stream.
+static void parse_chunked(
+    struct parse_result *const out,
+    struct corpus_entry const *const entry,
+    struct chunking const *const chunking,
+    struct cost_samples *const costs
+) {
+    static bip32_path_t const path = { .length = 4, .components = { 0x8000002c, 0x800006c1, 0x80000000, 0x80000000 } };
+
+    memset(&global, 0, sizeof(global));
+    global.sign_sessions.active = SIGN_SESSION_SLOT(0);
+    memset(out, 0, sizeof(*out));
+    parse_operations_init(&G.maybe_ops.v, DERIVATION_TYPE_ED25519, &path, &G.parse_state);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < chunking->count; i++) {
+        uint64_t const start = now_ns();
+        parse_operations_packet(&G.maybe_ops.v, &entry->op[offset], chunking->sizes[i], &is_operation_allowed);
+        uint64_t const end = now_ns();
+        if (costs != NULL) record_cost(costs, end - start);
+        offset += chunking->sizes[i];
+    }
+
+    out->valid = parse_operations_final(&G.parse_state, &G.maybe_ops.v);
+    memcpy(&out->ops, &G.maybe_ops.v, sizeof(out->ops));
+}
+
+static void chunk_evenly(struct chunking *const out, size_t const total, size_t const size) {
+    out->count = 0;
+    for (size_t offset = 0; offset < total; offset += size) {
+        out->sizes[out->count++] = total - offset < size ? total - offset : size;
+    }
+}
+
+static uint32_t xorshift32(uint32_t *const state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void chunk_randomly(struct chunking *const out, size_t const total, uint32_t *const rng) {
+    out->count = 0;
+    for (size_t offset = 0; offset < total; ) {
+        size_t size = 1 + xorshift32(rng) % MAX_APDU_SIZE;
+        if (size > total - offset) size = total - offset;
+        out->sizes[out->count++] = size;
+        offset += size;
+    }
+}
+
+static void describe_chunking(FILE *const out, struct chunking const *const chunking) {
+    for (size_t i = 0; i < chunking->count; i++) {
+        fprintf(out, "%s%zu", i == 0 ? "" : ",", chunking->sizes[i]);
+    }
+}
+
+// ------------------------------------------------------------ reporting
+
+static int compare_u64(void const *const a, void const *const b) {
+    uint64_t const x = *(uint64_t const *)a;
+    uint64_t const y = *(uint64_t const *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(struct cost_samples const *const samples, unsigned const pct) {
+    if (samples->count == 0) return 0;
+    return samples->ns[(samples->count - 1) * pct / 100];
+}
+
+static void report_costs(
+    struct corpus_entry const *const entry,
+    size_t const chunkings,
+    struct cost_samples *const chunk_costs,
+    struct cost_samples *const total_costs
+) {
+    qsort(chunk_costs->ns, chunk_costs->count, sizeof(*chunk_costs->ns), compare_u64);
+    qsort(total_costs->ns, total_costs->count, sizeof(*total_costs->ns), compare_u64);
+    printf("%-28s %5zu %6zu %6zu %7llu %7llu %7llu %7llu %8llu %8llu %8llu\n",
+           entry->name, entry->op_size, chunkings, chunk_costs->count,
+           (unsigned long long)percentile(chunk_costs, 50),
+           (unsigned long long)percentile(chunk_costs, 90),
+           (unsigned long long)percentile(chunk_costs, 99),
+           (unsigned long long)percentile(chunk_costs, 100),
+           (unsigned long long)percentile(total_costs, 0),
+           (unsigned long long)percentile(total_costs, 50),
+           (unsigned long long)percentile(total_costs, 100));
+}
+
+// ------------------------------------------------------------ main
+
+static bool check_entry(struct corpus_entry const *const entry) {
+    memcpy(signing_key.pkh, entry->pkh, sizeof(signing_key.pkh));
+    signing_key.compressed.W_len = sizeof(entry->public_key);
+    memcpy(signing_key.compressed.W, entry->public_key, sizeof(entry->public_key));
+
+    static struct chunking chunking;
+    static struct parse_result reference, result;
+    struct cost_samples chunk_costs = {0}, total_costs = {0};
+    size_t chunkings = 0;
+    bool ok = true;
+
+    chunk_evenly(&chunking, entry->op_size, MAX_APDU_SIZE);
+    parse_chunked(&reference, entry, &chunking, NULL);
+    if (reference.valid != entry->expect_valid) {
+        fprintf(stderr, "%s: expected %s parse, got %s\n", entry->name,
+                entry->expect_valid ? "valid" : "invalid", reference.valid ? "valid" : "invalid");
+        ok = false;
+    }
+
+    uint32_t rng = 0x2545F491;
+    size_t const two_way = entry->op_size - 1;
+    size_t const total = two_way + MAX_APDU_SIZE + RANDOM_CHUNKINGS;
+    for (size_t i = 0; i < total; i++) {
+        if (i < two_way) {
+            size_t const split = i + 1;
+            if (split > MAX_APDU_SIZE || entry->op_size - split > MAX_APDU_SIZE) continue;
+            chunking.count = 2;
+            chunking.sizes[0] = split;
+            chunking.sizes[1] = entry->op_size - split;
+        } else if (i < two_way + MAX_APDU_SIZE) {
+            chunk_evenly(&chunking, entry->op_size, i - two_way + 1);
+        } else {
+            chunk_randomly(&chunking, entry->op_size, &rng);
+        }
+
+        size_t const first_chunk_cost = chunk_costs.count;
+        parse_chunked(&result, entry, &chunking, &chunk_costs);
+        uint64_t sum = 0;
+        for (size_t c = first_chunk_cost; c < chunk_costs.count; c++) sum += chunk_costs.ns[c];
+        record_cost(&total_costs, sum);
+        chunkings++;
+
+        if (result.valid != reference.valid || memcmp(&result.ops, &reference.ops, sizeof(result.ops)) != 0) {
+            fprintf(stderr, "%s: chunking ", entry->name);
+            describe_chunking(stderr, &chunking);
+            fprintf(stderr, " differs from the reference parse\n");
+            ok = false;
+            break;
+        }
+    }
+
+    report_costs(entry, chunkings, &chunk_costs, &total_costs);
+    free(chunk_costs.ns);
+    free(total_costs.ns);
+    return ok;
+}
+
+// ------------------------------------------------------------ forged intents
+
+// Format, one entry per line: <name> <signing pkh> <public key> <intent> <operation>
+static bool read_intent(FILE *const in, struct corpus_entry *const out, uint8_t *const intent, size_t *const intent_size) {
+    char line[4 * MAX_OPERATION_SIZE];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        static char pkh[2 * HASH_SIZE + 1], public_key[2 * 32 + 1], intent_hex[2 * MAX_APDU_SIZE + 1],
+            op[2 * MAX_OPERATION_SIZE + 1];
+        if (sscanf(line, "%63s %40s %64s %460s %2048s", out->name, pkh, public_key, intent_hex, op) != 5) {
+            fprintf(stderr, "Bad intent line: %s", line);
+            exit(2);
+        }
+        out->expect_valid = true;
+        parse_hex(out->pkh, sizeof(out->pkh), pkh);
+        parse_hex(out->public_key, sizeof(out->public_key), public_key);
+        *intent_size = parse_hex(intent, MAX_APDU_SIZE, intent_hex);
+        out->op_size = parse_hex(out->op, sizeof(out->op), op);
+        return true;
+    }
+    return false;
+}
+
+// Mirrors what handle_apdu_sign_intent does before hashing.
+static bool check_intent(struct corpus_entry const *const entry, uint8_t const *const intent, size_t const intent_size) {
+    transfer_intent_t parsed;
+    parse_transfer_intent(&parsed, intent, intent_size);
+    parsed.source.originated = 0;
+    parsed.source.signature_type = SIGNATURE_TYPE_ED25519;
+    memcpy(parsed.source.hash, entry->pkh, sizeof(parsed.source.hash));
+
+    uint8_t forged[MAX_FORGED_INTENT_SIZE];
+    size_t const forged_size = forge_transfer_intent(forged, sizeof(forged), &parsed);
+    if (forged_size != entry->op_size || memcmp(forged, entry->op, forged_size) != 0) {
+        fprintf(stderr, "%s: forged operation differs from the expected one\n", entry->name);
+        return false;
+    }
+    return check_entry(entry);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "Usage: %s <corpus file> [<intent file>]\n", argv[0]);
+        return 2;
+    }
+    FILE *const corpus = fopen(argv[1], "r");
+    if (corpus == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    printf("Per-chunk and per-operation parse cost in nanoseconds\n");
+    printf("%-28s %5s %6s %6s %7s %7s %7s %7s %8s %8s %8s\n",
+           "operation", "bytes", "splits", "chunks",
+           "p50", "p90", "p99", "max", "op min", "op p50", "op max");
+
+    static struct corpus_entry entry;
+    size_t entries = 0, failures = 0;
+    while (read_entry(corpus, &entry)) {
+        entries++;
+        if (!check_entry(&entry)) failures++;
+    }
+    fclose(corpus);
+
+    if (entries == 0) {
+        fprintf(stderr, "Empty corpus\n");
+        return 2;
+    }
+    printf("%zu operations, %zu failed\n", entries, failures);
+
+    if (argc == 3) {
+        FILE *const intents = fopen(argv[2], "r");
+        if (intents == NULL) {
+            perror(argv[2]);
+            return 2;
+        }
+        static uint8_t intent[MAX_APDU_SIZE];
+        size_t intent_size, intent_entries = 0, intent_failures = 0;
+        while (read_intent(intents, &entry, intent, &intent_size)) {
+            intent_entries++;
+            if (!check_intent(&entry, intent, intent_size)) intent_failures++;
+        }
+        fclose(intents);
+        printf("%zu intents, %zu failed\n", intent_entries, intent_failures);
+        failures += intent_failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
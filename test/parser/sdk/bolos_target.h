@@ -0,0 +1,2 @@
+// Host stand-in for the BOLOS SDK's bolos_target.h. The host build is the Nano S wallet.
+#pragma once
@@ -0,0 +1,38 @@
+// Host stand-in for the BOLOS SDK's cx.h: types only, no cryptography.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE2B_BLOCKBYTES 128
+#define CX_SHA256_SIZE 32
+#define CX_SHA512_SIZE 64
+#define CX_LAST 1
+
+typedef enum {
+    CX_CURVE_NONE,
+    CX_CURVE_SECP256K1,
+    CX_CURVE_SECP256R1,
+    CX_CURVE_Ed25519,
+} cx_curve_t;
+
+typedef struct {
+    cx_curve_t curve;
+    unsigned int W_len;
+    unsigned char W[65];
+} cx_ecfp_public_key_t;
+
+typedef struct {
+    cx_curve_t curve;
+    unsigned int d_len;
+    unsigned char d[64];
+} cx_ecfp_private_key_t;
+
+typedef struct {
+    int algo;
+} cx_hash_t;
+
+typedef struct {
+    cx_hash_t header;
+    unsigned char state[240];
+} cx_blake2b_t;
@@ -0,0 +1,76 @@
+// Host stand-in for the parts of the BOLOS SDK's os.h that the parser needs.
+// Only what src/operations.c and the headers it pulls in use is provided.
+#pragma once
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CX_APILEVEL 10
+
+#define PIC(x) (x)
+#define PRINTF(...)
+
+typedef unsigned short exception_t;
+
+typedef struct try_context_s {
+    jmp_buf jmp_buf;
+    struct try_context_s *previous;
+    exception_t ex;
+} try_context_t;
+
+try_context_t *try_context_get(void);
+try_context_t *try_context_set(try_context_t *context);
+__attribute__((noreturn)) void os_longjmp(unsigned int exception);
+
+// Same shape as the SDK macros, so code behaves the same on the host. The `_L` variants label
+// a try block so that several can sit in one function.
+#define BEGIN_TRY_L(L) { try_context_t __try##L;
+#define TRY_L(L) \
+    __try##L.previous = try_context_set(&__try##L); \
+    __try##L.ex = setjmp(__try##L.jmp_buf); \
+    if (__try##L.ex == 0) {
+#define CATCH_L(L, x) \
+    goto __FINALLY##L; \
+    } else if (__try##L.ex == (x)) { \
+        __try##L.ex = 0; \
+        try_context_set(__try##L.previous);
+#define CATCH_OTHER_L(L, e) \
+    goto __FINALLY##L; \
+    } else { \
+        exception_t e; \
+        e = __try##L.ex; \
+        __try##L.ex = 0; \
+        try_context_set(__try##L.previous);
+#define FINALLY_L(L) \
+    goto __FINALLY##L; \
+    } \
+    __FINALLY##L: \
+    try_context_set(__try##L.previous);
+#define END_TRY_L(L) \
+    if (__try##L.ex != 0) { \
+        THROW(__try##L.ex); \
+    } \
+    }
+
+#define BEGIN_TRY BEGIN_TRY_L()
+#define TRY TRY_L()
+#define CATCH(x) CATCH_L(, x)
+#define CATCH_OTHER(e) CATCH_OTHER_L(, e)
+#define FINALLY FINALLY_L()
+#define END_TRY END_TRY_L()
+
+#define THROW(x) os_longjmp(x)
+
+#define INVALID_PARAMETER 0x0002
+#define EXCEPTION_IO_RESET 0x0010
+
+#define CHANNEL_APDU 0
+#define IO_RETURN_AFTER_TX 0x20
+#define IO_ASYNCH_REPLY 0x10
+#define IO_APDU_MEDIA_USB_HID 1
+
+extern unsigned char G_io_apdu_buffer[260];
+extern unsigned int G_io_apdu_media;
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
@@ -0,0 +1,8 @@
+// Host stand-in for the BOLOS SDK's os_io_seproxyhal.h.
+#pragma once
+
+#define IO_SEPROXYHAL_BUFFER_SIZE_B 128
+
+typedef struct {
+    int unused;
+} ux_state_t;
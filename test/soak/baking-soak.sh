@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -Eeuo pipefail
+
+# Runs the baking soak test against the connected device, or against an
+# emulator when LEDGER_PROXY_ADDRESS and LEDGER_PROXY_PORT are set.
+# All arguments are passed on; see `baking-soak.sh --help`.
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+root="$(git rev-parse --show-toplevel)"
+
+args=""
+for arg in "$@"; do
+  args+=" $(printf '%q' "$arg")"
+done
+
+nix-shell "$root/nix/ledgerblue.nix" -A shell --pure \
+  --keep LEDGER_PROXY_ADDRESS --keep LEDGER_PROXY_PORT \
+  --run "python $DIR/baking_soak.py$args"
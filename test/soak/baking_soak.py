@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Deterministic baking soak test.
+
+Plays the part of a node and a baker against a device running the baking app
+(a real Ledger or an emulator reached through LEDGER_PROXY_ADDRESS/PORT) for
+many consecutive levels. A seeded stub node decides, for each level, whether
+the baker has a baking slot, an endorsement slot, and whether a stale request
+for an already-signed level is replayed (as a restarted baker would). Every
+request is timed from the first APDU to the signature.
+
+For each level it records:
+  - the request-to-signature latency of every slot,
+  - high watermark refusals (0x6A80), expected for replays only,
+  - missed slots: no signature before the slot deadline, or a refusal for a
+    fresh level.
+
+The run fails when the p99 latency or the number of missed slots exceeds the
+given limits, or regresses against a summary written by an earlier run.
+
+The device must already be set up for baking (see "Setup ledger device to bake
+and endorse" in the README); the authorized key and chain are read back from
+it. Signing starts just above the device's current high watermark, so no
+prompt is ever shown during the run.
+"""
+
+import argparse
+import csv
+import json
+import random
+import struct
+import sys
+import time
+
+from ledgerblue.comm import getDongle
+from ledgerblue.commException import CommException
+
+CLA = 0x80
+INS_SIGN = 0x04
+INS_QUERY_ALL_HWM = 0x0B
+INS_QUERY_AUTH_KEY_WITH_CURVE = 0x0D
+
+P1_FIRST = 0x00
+P1_LAST_MARKER = 0x80
+
+MAGIC_BYTE_BLOCK = 0x01
+MAGIC_BYTE_BAKING_OP = 0x02
+
+SW_WRONG_VALUES = 0x6A80  # Level is at or below the high watermark.
+
+MAINNET_CHAIN_ID = 0x7A06A770  # NetXdQprcVkpaWU
+
+
+def apdu(ins, p1, p2, data=b""):
+    return bytes([CLA, ins, p1, p2, len(data)]) + data
+
+
+class Device:
+    def __init__(self, debug):
+        self.dongle = getDongle(debug)
+
+    def exchange(self, ins, p1=0, p2=0, data=b""):
+        return bytes(self.dongle.exchange(apdu(ins, p1, p2, data)))
+
+    def authorized_key(self):
+        response = self.exchange(INS_QUERY_AUTH_KEY_WITH_CURVE)
+        curve, length = response[0], response[1]
+        components = struct.unpack(">%dI" % length, response[2:2 + 4 * length])
+        return curve, components
+
+    def high_watermarks(self):
+        main, test, chain_id = struct.unpack(">III", self.exchange(INS_QUERY_ALL_HWM)[:12])
+        return main, test, chain_id
+
+    def sign(self, curve, path, payload):
+        path_bytes = bytes([len(path)]) + struct.pack(">%dI" % len(path), *path)
+        self.exchange(INS_SIGN, P1_FIRST, curve, path_bytes)
+        return self.exchange(INS_SIGN, P1_LAST_MARKER, curve, payload)
+
+
+class StubNode:
+    """Synthesizes the requests a baker would make, deterministically from a seed."""
+
+    def __init__(self, seed, chain_id, bake_probability, endorse_probability, replay_probability):
+        self.rng = random.Random(seed)
+        self.chain_id = chain_id
+        self.bake_probability = bake_probability
+        self.endorse_probability = endorse_probability
+        self.replay_probability = replay_probability
+        self.signed = []
+
+    def block(self, level):
+        predecessor = bytes(self.rng.getrandbits(8) for _ in range(32))
+        operations_hash = bytes(self.rng.getrandbits(8) for _ in range(32))
+        timestamp = 1570000000 + 60 * level
+        fitness = struct.pack(">I", 1) + b"\x01" + struct.pack(">II", 4, level)
+        return (struct.pack(">BIIB", MAGIC_BYTE_BLOCK, self.chain_id, level, 1)
+                + predecessor
+                + struct.pack(">QB", timestamp, 4)
+                + operations_hash
+                + struct.pack(">I", len(fitness)) + fitness)
+
+    def endorsement(self, level):
+        branch = bytes(self.rng.getrandbits(8) for _ in range(32))
+        return struct.pack(">BI", MAGIC_BYTE_BAKING_OP, self.chain_id) + branch + struct.pack(">BI", 0, level)
+
+    def requests(self, level):
+        """Yields (kind, level, payload, is_replay) for every slot at `level`."""
+        slots = []
+        if self.rng.random() < self.bake_probability:
+            slots.append(("block", level, self.block(level), False))
+        if self.rng.random() < self.endorse_probability:
+            slots.append(("endorsement", level, self.endorsement(level), False))
+        if self.signed and self.rng.random() < self.replay_probability:
+            kind, old_level = self.rng.choice(self.signed)
+            payload = self.block(old_level) if kind == "block" else self.endorsement(old_level)
+            slots.append((kind, old_level, payload, True))
+        for slot in slots:
+            if not slot[3]:
+                self.signed.append(slot[:2])
+        return slots
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[(len(ordered) - 1) * pct // 100]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--levels", type=int, default=5000, help="number of levels to play (default: %(default)s)")
+    parser.add_argument("--seed", type=int, default=1729, help="stub node seed (default: %(default)s)")
+    parser.add_argument("--bake-probability", type=float, default=0.3)
+    parser.add_argument("--endorse-probability", type=float, default=0.9)
+    parser.add_argument("--replay-probability", type=float, default=0.02,
+                        help="chance per level of replaying an already-signed slot, which must be refused")
+    parser.add_argument("--level-interval-ms", type=float, default=0,
+                        help="time between levels; 0 plays them back to back (default: %(default)s)")
+    parser.add_argument("--slot-deadline-ms", type=float, default=2000,
+                        help="signatures slower than this count as missed slots (default: %(default)s)")
+    parser.add_argument("--max-p99-ms", type=float, help="fail if p99 signing latency exceeds this")
+    parser.add_argument("--max-missed", type=int, default=0, help="fail if more slots are missed (default: %(default)s)")
+    parser.add_argument("--baseline", help="summary JSON of an earlier run to compare against")
+    parser.add_argument("--p99-tolerance", type=float, default=0.10,
+                        help="allowed p99 regression against the baseline, as a fraction (default: %(default)s)")
+    parser.add_argument("--levels-csv", help="write one row per slot to this file")
+    parser.add_argument("--summary", help="write the run summary as JSON to this file")
+    parser.add_argument("--debug", action="store_true", help="log every APDU")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    device = Device(args.debug)
+
+    curve, path = device.authorized_key()
+    if not path:
+        sys.exit("The device has no authorized baking key.")
+    main_hwm, _, chain_id = device.high_watermarks()
+    node = StubNode(args.seed, chain_id or MAINNET_CHAIN_ID,
+                    args.bake_probability, args.endorse_probability, args.replay_probability)
+    first_level = main_hwm + 1
+
+    rows = []
+    latencies = []
+    missed = 0
+    refusals = 0
+    unexpected_signatures = 0
+
+    for level in range(first_level, first_level + args.levels):
+        level_start = time.monotonic()
+        for kind, slot_level, payload, is_replay in node.requests(level):
+            start = time.monotonic()
+            try:
+                device.sign(curve, path, payload)
+                status = 0x9000
+            except CommException as e:
+                status = e.sw
+            latency_ms = (time.monotonic() - start) * 1000
+
+            if status == SW_WRONG_VALUES:
+                refusals += 1
+            if is_replay:
+                outcome = "refused" if status == SW_WRONG_VALUES else "signed-replay"
+                unexpected_signatures += status == 0x9000
+            elif status != 0x9000:
+                outcome = "refused" if status == SW_WRONG_VALUES else "error"
+                missed += 1
+            else:
+                latencies.append(latency_ms)
+                outcome = "signed"
+                if latency_ms > args.slot_deadline_ms:
+                    outcome = "late"
+                    missed += 1
+
+            rows.append({"level": level, "slot_level": slot_level, "kind": kind, "replay": int(is_replay),
+                         "latency_ms": "%.2f" % latency_ms, "status": "%04x" % status, "outcome": outcome})
+            if outcome not in ("signed", "refused"):
+                print("level %d: %s %s at level %d -> %s (%04x)" % (level, "replayed" if is_replay else "fresh",
+                                                                     kind, slot_level, outcome, status))
+
+        if args.level_interval_ms:
+            remaining = args.level_interval_ms / 1000 - (time.monotonic() - level_start)
+            if remaining > 0:
+                time.sleep(remaining)
+
+    summary = {
+        "seed": args.seed,
+        "levels": args.levels,
+        "first_level": first_level,
+        "slots": sum(1 for row in rows if not row["replay"]),
+        "signatures": len(latencies),
+        "missed_slots": missed,
+        "hwm_refusals": refusals,
+        "replays_signed": unexpected_signatures,
+        "latency_ms": {
+            "p50": percentile(latencies, 50),
+            "p90": percentile(latencies, 90),
+            "p99": percentile(latencies, 99),
+            "max": percentile(latencies, 100),
+        },
+    }
+
+    if args.levels_csv:
+        with open(args.levels_csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()) if rows else ["level"])
+            writer.writeheader()
+            writer.writerows(rows)
+    if args.summary:
+        with open(args.summary, "w") as f:
+            json.dump(summary, f, indent=2)
+
+    print(json.dumps(summary, indent=2))
+
+    failures = []
+    if unexpected_signatures:
+        failures.append("%d replayed slots were signed" % unexpected_signatures)
+    if missed > args.max_missed:
+        failures.append("%d missed slots, limit is %d" % (missed, args.max_missed))
+    p99 = summary["latency_ms"]["p99"]
+    if args.max_p99_ms is not None and p99 > args.max_p99_ms:
+        failures.append("p99 latency %.2f ms, limit is %.2f ms" % (p99, args.max_p99_ms))
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        baseline_p99 = baseline["latency_ms"]["p99"]
+        if p99 > baseline_p99 * (1 + args.p99_tolerance):
+            failures.append("p99 latency %.2f ms regressed from %.2f ms" % (p99, baseline_p99))
+        if missed > baseline["missed_slots"]:
+            failures.append("%d missed slots, baseline had %d" % (missed, baseline["missed_slots"]))
+
+    for failure in failures:
+        print("FAIL: " + failure)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())